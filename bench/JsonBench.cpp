@@ -0,0 +1,277 @@
+#include "../src/core/JsonParser.h"
+#include "../src/core/JsonDocument.h"
+#include "../src/core/FrameArena.h"
+#include "../src/core/Event.h"
+#include "../src/api/OneBotApi.h"
+#include "../src/network/WebSocketMask.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+LCHBOT_DEFINE_ALLOCATION_HOOKS()
+
+namespace LCHBOT {
+
+struct CorpusEntry {
+    std::string name;
+    std::string json;
+    bool is_event = false;
+};
+
+class Corpus {
+public:
+    static std::string groupMessage(int index) {
+        std::string uid = std::to_string(10000 + index);
+        std::string text = "message " + std::to_string(index) + " \xE4\xBD\xA0\xE5\xA5\xBD, \\\"quoted\\\" and a newline\\n";
+        return "{\"time\":1700000000,\"self_id\":123456789,\"post_type\":\"message\",\"message_type\":\"group\","
+               "\"sub_type\":\"normal\",\"message_id\":" + std::to_string(-1000 - index) + ",\"group_id\":987654321,"
+               "\"user_id\":" + uid + ",\"anonymous\":null,"
+               "\"message\":["
+               "{\"type\":\"reply\",\"data\":{\"id\":\"" + std::to_string(5000 + index) + "\"}},"
+               "{\"type\":\"at\",\"data\":{\"qq\":\"123456789\"}},"
+               "{\"type\":\"text\",\"data\":{\"text\":\"" + text + "\"}},"
+               "{\"type\":\"face\",\"data\":{\"id\":\"178\"}},"
+               "{\"type\":\"image\",\"data\":{\"file\":\"abcdef0123456789.image\",\"url\":\"https://example.invalid/img?fileid=abcdef0123456789&amp;spec=0\",\"subType\":0}}"
+               "],"
+               "\"raw_message\":\"[CQ:reply,id=" + std::to_string(5000 + index) + "][CQ:at,qq=123456789]" + text + "[CQ:face,id=178][CQ:image,file=abcdef0123456789.image]\","
+               "\"font\":0,"
+               "\"sender\":{\"user_id\":" + uid + ",\"nickname\":\"member" + uid + "\",\"card\":\"\",\"sex\":\"unknown\",\"age\":0,\"area\":\"\",\"level\":\"12\",\"role\":\"member\",\"title\":\"\"}}";
+    }
+
+    static std::string memberList(int count) {
+        std::string json = "{\"status\":\"ok\",\"retcode\":0,\"data\":[";
+        for (int i = 0; i < count; ++i) {
+            if (i > 0) json += ",";
+            std::string uid = std::to_string(100000 + i);
+            json += "{\"group_id\":987654321,\"user_id\":" + uid + ",\"nickname\":\"\xE6\x88\x90\xE5\x91\x98" + uid + "\","
+                    "\"card\":\"" + (i % 3 == 0 ? "card" + uid : std::string()) + "\",\"sex\":\"unknown\",\"age\":0,\"area\":\"\","
+                    "\"join_time\":1650000000,\"last_sent_time\":1700000000,\"level\":\"1\",\"role\":\"" + (i == 0 ? "owner" : "member") + "\","
+                    "\"unfriendly\":false,\"title\":\"\",\"title_expire_time\":0,\"card_changeable\":true}";
+        }
+        json += "],\"echo\":\"lchbot_42\"}";
+        return json;
+    }
+
+    static std::string heartbeat() {
+        return "{\"time\":1700000000,\"self_id\":123456789,\"post_type\":\"meta_event\",\"meta_event_type\":\"heartbeat\","
+               "\"status\":{\"online\":true,\"good\":true},\"interval\":30000}";
+    }
+
+    static std::vector<CorpusEntry> build(const std::string& api_test_path) {
+        std::vector<CorpusEntry> corpus;
+        for (int i = 0; i < 64; ++i) {
+            corpus.push_back({"group_message_" + std::to_string(i), groupMessage(i), true});
+        }
+        corpus.push_back({"heartbeat", heartbeat(), true});
+        corpus.push_back({"member_list_50", memberList(50), false});
+        corpus.push_back({"member_list_500", memberList(500), false});
+        corpus.push_back({"member_list_3000", memberList(3000), false});
+
+        std::ifstream file(api_test_path, std::ios::binary);
+        if (file) {
+            std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            if (content.compare(0, 3, "\xEF\xBB\xBF") == 0) content.erase(0, 3);
+            corpus.push_back({"api_test", std::move(content), false});
+        } else {
+            std::fprintf(stderr, "warning: %s not found, skipping\n", api_test_path.c_str());
+        }
+        return corpus;
+    }
+};
+
+struct BenchResult {
+    double ns_per_op = 0;
+    double mb_per_s = 0;
+    double items_per_s = 0;
+    double allocs_per_op = 0;
+    double alloc_bytes_per_op = 0;
+};
+
+class BenchRunner {
+public:
+    BenchRunner(std::string filter, double min_seconds) : filter_(std::move(filter)), min_seconds_(min_seconds) {}
+
+    void header() const {
+        std::printf("%-36s %12s %10s %14s %10s %12s\n", "benchmark", "ns/op", "MB/s", "items/s", "allocs/op", "bytes/op");
+    }
+
+    void run(const std::string& name, size_t bytes_per_op, size_t items_per_op, const std::function<void()>& op) {
+        if (!filter_.empty() && name.find(filter_) == std::string::npos) return;
+
+        op();
+
+        uint64_t iterations = 1;
+        BenchResult result;
+        while (true) {
+            AllocationStats::Snapshot before = AllocationStats::instance().snapshot();
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < iterations; ++i) op();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (seconds >= min_seconds_ || iterations >= (1ull << 30)) {
+                double n = static_cast<double>(iterations);
+                result.ns_per_op = seconds * 1e9 / n;
+                result.mb_per_s = static_cast<double>(bytes_per_op) * n / seconds / (1024.0 * 1024.0);
+                result.items_per_s = static_cast<double>(items_per_op) * n / seconds;
+                AllocationStats::Snapshot after = AllocationStats::instance().snapshot();
+                result.allocs_per_op = static_cast<double>(after.heap_allocations - before.heap_allocations) / n;
+                result.alloc_bytes_per_op = static_cast<double>(after.heap_bytes - before.heap_bytes) / n;
+                break;
+            }
+            iterations = seconds > 0 ? std::max<uint64_t>(iterations * 2, static_cast<uint64_t>(iterations * min_seconds_ / seconds * 1.2)) : iterations * 10;
+        }
+
+        std::printf("%-36s %12.0f %10.1f %14.0f %10.1f %12.0f\n",
+                    name.c_str(), result.ns_per_op, result.mb_per_s, result.items_per_s,
+                    result.allocs_per_op, result.alloc_bytes_per_op);
+    }
+
+private:
+    std::string filter_;
+    double min_seconds_;
+};
+
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}
+
+int main(int argc, char** argv) {
+    using namespace LCHBOT;
+
+    std::string filter;
+    std::string api_test_path = "api_test.json";
+    double min_seconds = 0.5;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (arg == "--min-time" && i + 1 < argc) min_seconds = std::atof(argv[++i]);
+        else if (arg == "--api-test" && i + 1 < argc) api_test_path = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--filter substr] [--min-time seconds] [--api-test path]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<CorpusEntry> corpus = Corpus::build(api_test_path);
+    BenchRunner runner(filter, min_seconds);
+    runner.header();
+
+    std::string messages_name = "group_message_x64";
+
+    auto forEachTarget = [&](const std::function<void(const std::string&, const std::vector<const CorpusEntry*>&)>& f) {
+        std::vector<const CorpusEntry*> messages;
+        for (const auto& entry : corpus) {
+            if (entry.name.rfind("group_message_", 0) == 0) {
+                messages.push_back(&entry);
+            } else {
+                f(entry.name, {&entry});
+            }
+        }
+        f(messages_name, messages);
+    };
+
+    auto totalBytes = [](const std::vector<const CorpusEntry*>& entries) {
+        size_t n = 0;
+        for (const auto* e : entries) n += e->json.size();
+        return n;
+    };
+
+    forEachTarget([&](const std::string& name, const std::vector<const CorpusEntry*>& entries) {
+        runner.run("parse/" + name, totalBytes(entries), entries.size(), [&] {
+            for (const auto* e : entries) {
+                JsonValue v = JsonParser::parse(e->json);
+                doNotOptimize(v);
+            }
+        });
+    });
+
+    forEachTarget([&](const std::string& name, const std::vector<const CorpusEntry*>& entries) {
+        std::vector<JsonValue> values;
+        for (const auto* e : entries) values.push_back(JsonParser::parse(e->json));
+        runner.run("stringify/" + name, totalBytes(entries), entries.size(), [&] {
+            for (const auto& v : values) {
+                std::string s = JsonParser::stringify(v);
+                doNotOptimize(s);
+            }
+        });
+    });
+
+    forEachTarget([&](const std::string& name, const std::vector<const CorpusEntry*>& entries) {
+        runner.run("document/" + name, totalBytes(entries), entries.size(), [&] {
+            for (const auto* e : entries) {
+                auto doc = JsonDocument::parse(e->json);
+                doNotOptimize(doc);
+            }
+        });
+    });
+
+    forEachTarget([&](const std::string& name, const std::vector<const CorpusEntry*>& entries) {
+        if (!entries.front()->is_event) return;
+        runner.run("event/" + name, totalBytes(entries), entries.size(), [&] {
+            for (const auto* e : entries) {
+                std::shared_ptr<const JsonDocument> doc = JsonDocument::adopt(e->json);
+                auto event = EventParser::parse(doc);
+                doNotOptimize(event);
+            }
+        });
+    });
+
+    forEachTarget([&](const std::string& name, const std::vector<const CorpusEntry*>& entries) {
+        if (!entries.front()->is_event) return;
+        runner.run("event_legacy/" + name, totalBytes(entries), entries.size(), [&] {
+            for (const auto* e : entries) {
+                auto event = EventParser::parse(JsonParser::parse(e->json));
+                doNotOptimize(event);
+            }
+        });
+    });
+
+    OneBotApi api;
+    size_t sent_bytes = 0;
+    api.setSendFunction([&](const std::string& payload) { sent_bytes += payload.size(); });
+
+    std::string text = "reply text \xE4\xBD\xA0\xE5\xA5\xBD with \"quotes\" and\nnewlines";
+    runner.run("api/send_group_msg_text", text.size(), 1, [&] {
+        std::string echo = api.sendGroupMsg(987654321, text);
+        doNotOptimize(echo);
+    });
+
+    std::vector<MessageSegment> segments = {
+        OneBotApi::reply(5000),
+        OneBotApi::at(123456789),
+        OneBotApi::text(text),
+        OneBotApi::face(178),
+        OneBotApi::image("https://example.invalid/image.png"),
+    };
+    runner.run("api/send_group_msg_segments", text.size(), 1, [&] {
+        std::string echo = api.sendGroupMsg(987654321, segments);
+        doNotOptimize(echo);
+    });
+
+    runner.run("api/set_group_ban", 0, 1, [&] {
+        std::string echo = api.setGroupBan(987654321, 10001, 600);
+        doNotOptimize(echo);
+    });
+
+    const uint8_t mask_key[4] = {0x12, 0x34, 0x56, 0x78};
+    for (size_t size : {size_t(125), size_t(4096), size_t(1) << 20}) {
+        std::string payload(size, 'x');
+        std::string masked(size, '\0');
+        runner.run("ws/mask_" + std::to_string(size) + "_" + WebSocketMask::backend(), size, 1, [&] {
+            WebSocketMask::copy(masked.data(), payload.data(), payload.size(), mask_key);
+            doNotOptimize(masked);
+        });
+    }
+
+    doNotOptimize(sent_bytes);
+    return 0;
+}
@@ -1,12 +1,12 @@
 #pragma once
 
 #include <string>
-#include <sstream>
 #include "AdminServer.h"
 #include "Statistics.h"
 #include "../plugin/PluginManager.h"
 #include "../ai/PersonalitySystem.h"
 #include "../core/Logger.h"
+#include "../core/JsonWriter.h"
 #include "../core/PermissionSystem.h"
 #include "../core/RateLimiter.h"
 #include "../core/MetricsExporter.h"
@@ -81,14 +81,14 @@ private:
         auto& plugins = PluginManager::instance();
         auto& personalities = PersonalitySystem::instance();
         
-        std::ostringstream json;
-        json << "{";
-        json << "\"total_calls\":" << stats.getTotalApiCalls() << ",";
-        json << "\"active_groups\":" << stats.getActiveGroupCount() << ",";
-        json << "\"total_plugins\":" << plugins.getPluginList().size() << ",";
-        json << "\"total_personalities\":" << personalities.listPersonalities().size();
-        json << "}";
-        return json.str();
+        JsonWriter json;
+        json.beginObject();
+        json.field("total_calls", stats.getTotalApiCalls());
+        json.field("active_groups", stats.getActiveGroupCount());
+        json.field("total_plugins", plugins.getPluginList().size());
+        json.field("total_personalities", personalities.listPersonalities().size());
+        json.endObject();
+        return json.take();
     }
     
     std::string handlePlugins(const std::string& method, const std::string& path, const std::string& body) {
@@ -121,42 +121,40 @@ private:
         }
         
         auto list = mgr.getPluginList();
-        std::ostringstream json;
-        json << "{\"plugins\":[";
-        bool first = true;
+        JsonWriter json;
+        json.beginObject();
+        json.key("plugins").beginArray();
         for (const auto& info : list) {
-            if (!first) json << ",";
-            first = false;
-            json << "{";
-            json << "\"name\":\"" << escapeJson(info.name) << "\",";
-            json << "\"version\":\"" << escapeJson(info.version) << "\",";
-            json << "\"author\":\"" << escapeJson(info.author) << "\",";
-            json << "\"description\":\"" << escapeJson(info.description) << "\",";
-            json << "\"icon\":\"" << escapeJson(info.icon) << "\",";
-            json << "\"enabled\":" << (mgr.isPluginEnabled(info.name) ? "true" : "false");
-            json << "}";
+            json.beginObject();
+            json.field("name", info.name);
+            json.field("version", info.version);
+            json.field("author", info.author);
+            json.field("description", info.description);
+            json.field("icon", info.icon);
+            json.field("enabled", mgr.isPluginEnabled(info.name));
+            json.endObject();
         }
-        json << "]}";
-        return json.str();
+        json.endArray();
+        json.endObject();
+        return json.take();
     }
     
     std::string handlePersonalities(const std::string& method, const std::string& path, const std::string& body) {
         auto& ps = PersonalitySystem::instance();
         auto list = ps.listPersonalities();
         
-        std::ostringstream json;
-        json << "{\"personalities\":[";
-        bool first = true;
+        JsonWriter json;
+        json.beginObject();
+        json.key("personalities").beginArray();
         for (const auto& [id, name] : list) {
-            if (!first) json << ",";
-            first = false;
-            json << "{";
-            json << "\"id\":\"" << escapeJson(id) << "\",";
-            json << "\"name\":\"" << escapeJson(name) << "\"";
-            json << "}";
+            json.beginObject();
+            json.field("id", id);
+            json.field("name", name);
+            json.endObject();
         }
-        json << "]}";
-        return json.str();
+        json.endArray();
+        json.endObject();
+        return json.take();
     }
     
     std::string handleGroups(const std::string& method, const std::string& path, const std::string& body) {
@@ -164,21 +162,19 @@ private:
         auto& ps = PersonalitySystem::instance();
         auto group_stats = stats.getGroupStats();
         
-        std::ostringstream json;
-        json << "{\"groups\":[";
-        bool first = true;
+        JsonWriter json;
+        json.beginObject();
+        json.key("groups").beginArray();
         for (const auto& [id, gs] : group_stats) {
-            if (!first) json << ",";
-            first = false;
-            std::string personality_name = ps.getNameForGroup(id);
-            json << "{";
-            json << "\"id\":" << id << ",";
-            json << "\"personality\":\"" << escapeJson(personality_name) << "\",";
-            json << "\"calls\":" << gs.call_count.load();
-            json << "}";
+            json.beginObject();
+            json.field("id", id);
+            json.field("personality", ps.getNameForGroup(id));
+            json.field("calls", gs.call_count.load());
+            json.endObject();
         }
-        json << "]}";
-        return json.str();
+        json.endArray();
+        json.endObject();
+        return json.take();
     }
     
     std::string handleReload(const std::string& method, const std::string& path, const std::string& body) {
@@ -206,45 +202,30 @@ private:
         return path.substr(start, end - start);
     }
     
-    std::string escapeJson(const std::string& str) {
-        std::string result;
-        for (char c : str) {
-            switch (c) {
-                case '"': result += "\\\""; break;
-                case '\\': result += "\\\\"; break;
-                case '\n': result += "\\n"; break;
-                case '\r': result += "\\r"; break;
-                case '\t': result += "\\t"; break;
-                default: result += c;
-            }
-        }
-        return result;
-    }
-    
     std::string handleMetrics(const std::string& method, const std::string& path, const std::string& body) {
         auto& metrics = MetricsExporter::instance();
         auto& cache = ResponseCache::instance();
         auto& trace = TraceSystem::instance();
         
-        std::ostringstream json;
-        json << "{";
-        json << "\"cache\":{";
+        JsonWriter json;
+        json.beginObject();
+        json.key("cache").beginObject();
         auto cache_stats = cache.getStats();
-        json << "\"hits\":" << cache_stats.hits << ",";
-        json << "\"misses\":" << cache_stats.misses << ",";
-        json << "\"hit_rate\":" << cache.getHitRate() << ",";
-        json << "\"size_bytes\":" << cache_stats.total_bytes << ",";
-        json << "\"entries\":" << cache_stats.entry_count;
-        json << "},";
+        json.field("hits", cache_stats.hits);
+        json.field("misses", cache_stats.misses);
+        json.field("hit_rate", cache.getHitRate());
+        json.field("size_bytes", cache_stats.total_bytes);
+        json.field("entries", cache_stats.entry_count);
+        json.endObject();
         
         auto trace_stats = trace.getStats();
-        json << "\"trace\":{";
-        json << "\"total_spans\":" << trace_stats.total_spans << ",";
-        json << "\"avg_duration_ms\":" << trace_stats.avg_duration_ms << ",";
-        json << "\"errors\":" << trace_stats.errors;
-        json << "}";
-        json << "}";
-        return json.str();
+        json.key("trace").beginObject();
+        json.field("total_spans", trace_stats.total_spans);
+        json.field("avg_duration_ms", trace_stats.avg_duration_ms);
+        json.field("errors", trace_stats.errors);
+        json.endObject();
+        json.endObject();
+        return json.take();
     }
     
     std::string handlePermissions(const std::string& method, const std::string& path, const std::string& body) {
@@ -254,26 +235,25 @@ private:
             return "{\"error\":\"Not implemented\"}";
         }
         
-        std::ostringstream json;
-        json << "{";
-        json << "\"owners\":[";
-        auto owners = perms.getOwners();
-        for (size_t i = 0; i < owners.size(); i++) {
-            if (i > 0) json << ",";
-            json << owners[i];
+        JsonWriter json;
+        json.beginObject();
+        json.key("owners").beginArray();
+        for (int64_t owner : perms.getOwners()) {
+            json.value(owner);
         }
-        json << "],";
+        json.endArray();
         
-        json << "\"admins\":[";
-        auto admins = perms.getAdmins();
-        for (size_t i = 0; i < admins.size(); i++) {
-            if (i > 0) json << ",";
-            json << "{\"id\":" << admins[i].first << ",\"level\":" << static_cast<int>(admins[i].second) << "}";
+        json.key("admins").beginArray();
+        for (const auto& [id, level] : perms.getAdmins()) {
+            json.beginObject();
+            json.field("id", id);
+            json.field("level", static_cast<int>(level));
+            json.endObject();
         }
-        json << "],";
-        json << "\"stats\":\"" << escapeJson(perms.exportStats()) << "\"";
-        json << "}";
-        return json.str();
+        json.endArray();
+        json.field("stats", perms.exportStats());
+        json.endObject();
+        return json.take();
     }
     
     std::string handleTraces(const std::string& method, const std::string& path, const std::string& body) {
@@ -284,14 +264,15 @@ private:
         }
         
         auto spans = trace.getRecentSpans(50);
-        std::ostringstream json;
-        json << "{\"spans\":[";
-        for (size_t i = 0; i < spans.size(); i++) {
-            if (i > 0) json << ",";
-            json << trace.formatSpanJson(spans[i]);
+        JsonWriter json;
+        json.beginObject();
+        json.key("spans").beginArray();
+        for (const auto& span : spans) {
+            json.rawValue(trace.formatSpanJson(span));
         }
-        json << "]}";
-        return json.str();
+        json.endArray();
+        json.endObject();
+        return json.take();
     }
     
     std::string handleCache(const std::string& method, const std::string& path, const std::string& body) {
@@ -303,36 +284,37 @@ private:
         }
         
         auto stats = cache.getStats();
-        std::ostringstream json;
-        json << "{";
-        json << "\"hits\":" << stats.hits << ",";
-        json << "\"misses\":" << stats.misses << ",";
-        json << "\"evictions\":" << stats.evictions << ",";
-        json << "\"hit_rate\":" << cache.getHitRate() << ",";
-        json << "\"size_bytes\":" << stats.total_bytes << ",";
-        json << "\"entries\":" << stats.entry_count;
-        json << "}";
-        return json.str();
+        JsonWriter json;
+        json.beginObject();
+        json.field("hits", stats.hits);
+        json.field("misses", stats.misses);
+        json.field("evictions", stats.evictions);
+        json.field("hit_rate", cache.getHitRate());
+        json.field("size_bytes", stats.total_bytes);
+        json.field("entries", stats.entry_count);
+        json.endObject();
+        return json.take();
     }
     
     std::string handleSandbox(const std::string& method, const std::string& path, const std::string& body) {
         auto& sandbox = PluginSandbox::instance();
         auto stats = sandbox.getAllStats();
         
-        std::ostringstream json;
-        json << "{\"plugins\":[";
-        for (size_t i = 0; i < stats.size(); i++) {
-            if (i > 0) json << ",";
-            json << "{";
-            json << "\"name\":\"" << escapeJson(stats[i].plugin_name) << "\",";
-            json << "\"enabled\":" << (stats[i].enabled ? "true" : "false") << ",";
-            json << "\"memory\":" << stats[i].memory_used << ",";
-            json << "\"cpu_us\":" << stats[i].cpu_time_us << ",";
-            json << "\"violations\":" << stats[i].violations;
-            json << "}";
+        JsonWriter json;
+        json.beginObject();
+        json.key("plugins").beginArray();
+        for (const auto& plugin : stats) {
+            json.beginObject();
+            json.field("name", plugin.plugin_name);
+            json.field("enabled", plugin.enabled);
+            json.field("memory", plugin.memory_used);
+            json.field("cpu_us", plugin.cpu_time_us);
+            json.field("violations", plugin.violations);
+            json.endObject();
         }
-        json << "]}";
-        return json.str();
+        json.endArray();
+        json.endObject();
+        return json.take();
     }
 };
 
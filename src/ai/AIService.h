@@ -22,6 +22,7 @@
 #endif
 
 #include "../core/Logger.h"
+#include "../core/TextEscape.h"
 #include "../core/ErrorCodes.h"
 #include "../core/Calendar.h"
 #include "../admin/Statistics.h"
@@ -506,18 +507,7 @@ private:
     }
     
     std::string escapeJson(const std::string& str) {
-        std::string result;
-        for (char c : str) {
-            switch (c) {
-                case '"': result += "\\\""; break;
-                case '\\': result += "\\\\"; break;
-                case '\n': result += "\\n"; break;
-                case '\r': result += "\\r"; break;
-                case '\t': result += "\\t"; break;
-                default: result += c; break;
-            }
-        }
-        return result;
+        return TextEscape::json(str);
     }
     
     std::string getRequestFormat() const {
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "../core/Types.h"
+#include "../core/JsonWriter.h"
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace LCHBOT {
+
+template <size_t N>
+struct FixedString {
+    char value[N]{};
+
+    constexpr FixedString(const char (&s)[N]) {
+        for (size_t i = 0; i < N; ++i) value[i] = s[i];
+    }
+
+    constexpr size_t size() const { return N - 1; }
+    constexpr std::string_view view() const { return std::string_view(value, N - 1); }
+
+    constexpr bool isPlainJson() const {
+        for (size_t i = 0; i + 1 < N; ++i) {
+            if (value[i] == '"' || value[i] == '\\' || static_cast<unsigned char>(value[i]) < 0x20) return false;
+        }
+        return true;
+    }
+};
+
+template <FixedString... Parts>
+struct Fragment {
+    static constexpr size_t size = (Parts.size() + ...);
+
+    static constexpr std::array<char, size> build() {
+        std::array<char, size> out{};
+        size_t pos = 0;
+        ((appendPart(out, pos, Parts.view())), ...);
+        return out;
+    }
+
+    static constexpr void appendPart(std::array<char, size>& out, size_t& pos, std::string_view part) {
+        for (char c : part) out[pos++] = c;
+    }
+
+    static constexpr std::array<char, size> data = build();
+
+    static constexpr std::string_view view() { return std::string_view(data.data(), size); }
+};
+
+struct ActionValue {
+    static void write(std::string& out, bool v) {
+        out.append(v ? "true" : "false");
+    }
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    static void write(std::string& out, T v) {
+        JsonWriter::appendNumber(out, v);
+    }
+
+    static void write(std::string& out, std::string_view v) {
+        out.push_back('"');
+        JsonWriter::escape(out, v);
+        out.push_back('"');
+    }
+
+    static void write(std::string& out, const std::vector<MessageSegment>& message) {
+        out.push_back('[');
+        bool first = true;
+        for (const auto& seg : message) {
+            if (!first) out.push_back(',');
+            first = false;
+            out.append("{\"type\":");
+            write(out, std::string_view(seg.type));
+            out.append(",\"data\":{");
+            bool first_field = true;
+            for (const auto& [k, v] : seg.data) {
+                if (!first_field) out.push_back(',');
+                first_field = false;
+                write(out, std::string_view(k));
+                out.push_back(':');
+                write(out, std::string_view(v));
+            }
+            out.append("}}");
+        }
+        out.push_back(']');
+    }
+
+    static void write(std::string& out, const JsonValue& v) {
+        JsonWriter writer(out);
+        writer.value(v);
+    }
+};
+
+template <FixedString Name, typename T>
+struct Param {
+    static_assert(Name.isPlainJson(), "parameter names are emitted without escaping");
+
+    using type = T;
+
+    template <bool First>
+    static void write(std::string& out, const T& v) {
+        if constexpr (First) {
+            out.append(Fragment<"\"", Name, "\":">::view());
+        } else {
+            out.append(Fragment<",\"", Name, "\":">::view());
+        }
+        ActionValue::write(out, v);
+    }
+};
+
+template <FixedString Name, typename T>
+struct Param<Name, std::optional<T>> {
+    static_assert(Name.isPlainJson(), "parameter names are emitted without escaping");
+
+    using type = std::optional<T>;
+
+    template <bool First>
+    static void write(std::string& out, const std::optional<T>& v) {
+        static_assert(!First, "the first action parameter cannot be optional");
+        if (!v) return;
+        out.append(Fragment<",\"", Name, "\":">::view());
+        ActionValue::write(out, *v);
+    }
+};
+
+template <FixedString Action, typename... Params>
+struct ActionDescriptor {
+    static_assert(Action.isPlainJson(), "action names are emitted without escaping");
+
+    static constexpr std::string_view name() { return Action.view(); }
+
+    static void write(std::string& out, std::string_view echo, const typename Params::type&... args) {
+        out.append(Fragment<"{\"action\":\"", Action, "\",\"params\":{">::view());
+        writeParams(out, std::index_sequence_for<Params...>{}, args...);
+        out.append("},\"echo\":\"");
+        JsonWriter::escape(out, echo);
+        out.append("\"}");
+    }
+
+private:
+    template <size_t... I>
+    static void writeParams(std::string& out, std::index_sequence<I...>, const typename Params::type&... args) {
+        (Params::template write<I == 0>(out, args), ...);
+    }
+};
+
+}
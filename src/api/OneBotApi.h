@@ -2,6 +2,9 @@
 
 #include "../core/Types.h"
 #include "../core/JsonParser.h"
+#include "../core/JsonCursor.h"
+#include "../core/JsonWriter.h"
+#include "ActionSchema.h"
 #include "../core/Logger.h"
 #include <string>
 #include <map>
@@ -18,6 +21,20 @@ public:
     using SendFunc = std::function<void(const std::string&)>;
     using ResponseCallback = std::function<void(const ApiResponse&)>;
     
+    class RouteScope {
+    public:
+        explicit RouteScope(int64_t route) : previous_(current_route_) { current_route_ = route; }
+        ~RouteScope() { current_route_ = previous_; }
+        
+        RouteScope(const RouteScope&) = delete;
+        RouteScope& operator=(const RouteScope&) = delete;
+        
+    private:
+        int64_t previous_;
+    };
+    
+    static int64_t currentRoute() { return current_route_; }
+    
     void setSendFunction(SendFunc func) {
         send_func_ = std::move(func);
     }
@@ -26,7 +43,7 @@ public:
         if (!json.isObject()) return;
         const auto& obj = json.asObject();
         
-        auto echo_it = obj.find("echo");
+        auto echo_it = obj.find(Key::Echo);
         if (echo_it == obj.end()) return;
         
         std::string echo = echo_it->second.asString();
@@ -43,43 +60,59 @@ public:
         
         if (callback) {
             ApiResponse response;
-            if (obj.find("status") != obj.end()) response.status = obj.at("status").asString();
-            if (obj.find("retcode") != obj.end()) response.retcode = static_cast<int32_t>(obj.at("retcode").asInt());
-            if (obj.find("data") != obj.end()) response.data = obj.at("data");
+            for (const auto& [key, value] : obj) {
+                switch (key.atom()) {
+                    case Key::Status: response.status = value.asString(); break;
+                    case Key::Retcode: response.retcode = static_cast<int32_t>(value.asInt()); break;
+                    case Key::Data: response.data = value; break;
+                    default: break;
+                }
+            }
             response.echo = echo;
             callback(response);
         }
     }
     
+    void handleResponse(const std::shared_ptr<const JsonDocument>& doc) {
+        JsonCursor json(doc->buffer());
+        if (!json.isObject()) return;
+        
+        ApiResponse response;
+        JsonCursor echo_v;
+        json.forEachField([&](std::string_view key, const JsonCursor& v) {
+            switch (KeyTable::lookup(key)) {
+                case Key::Echo: echo_v = v; break;
+                case Key::Status: response.status = v.getString(); break;
+                case Key::Retcode: response.retcode = static_cast<int32_t>(v.getInt64(0)); break;
+                default: break;
+            }
+        });
+        if (!echo_v.valid()) return;
+        
+        std::string echo = echo_v.isString() ? echo_v.getString() : std::string(echo_v.raw());
+        
+        ResponseCallback callback = takeCallback(echo);
+        if (!callback) return;
+        
+        response.data = doc->root().find(Key::Data).toValue();
+        response.echo = echo;
+        callback(response);
+    }
+    
     std::string sendPrivateMsg(int64_t user_id, const std::string& message, bool auto_escape = false) {
-        std::map<std::string, JsonValue> params;
-        params["user_id"] = JsonValue(user_id);
-        params["message"] = JsonValue(message);
-        params["auto_escape"] = JsonValue(auto_escape);
-        return callApi("send_private_msg", JsonValue(params));
+        return callAction<SendPrivateMsgText>(user_id, message, auto_escape);
     }
     
     std::string sendPrivateMsg(int64_t user_id, const std::vector<MessageSegment>& message) {
-        std::map<std::string, JsonValue> params;
-        params["user_id"] = JsonValue(user_id);
-        params["message"] = serializeMessage(message);
-        return callApi("send_private_msg", JsonValue(params));
+        return callAction<SendPrivateMsgSegments>(user_id, message);
     }
     
     std::string sendGroupMsg(int64_t group_id, const std::string& message, bool auto_escape = false) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["message"] = JsonValue(message);
-        params["auto_escape"] = JsonValue(auto_escape);
-        std::string echo = callApi("send_group_msg", JsonValue(params));
-        return echo;
+        return callAction<SendGroupMsgText>(group_id, message, auto_escape);
     }
     
     std::string sendGroupMsg(int64_t group_id, const std::vector<MessageSegment>& message) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["message"] = serializeMessage(message);
-        return callApi("send_group_msg", JsonValue(params));
+        return callAction<SendGroupMsgSegments>(group_id, message);
     }
     
     std::string sendGroupMsgReply(int64_t group_id, int32_t reply_msg_id, const std::string& message) {
@@ -97,300 +130,304 @@ public:
     }
     
     std::string sendMsg(MessageType type, int64_t id, const std::string& message, bool auto_escape = false) {
-        std::map<std::string, JsonValue> params;
-        params["message_type"] = JsonValue(type == MessageType::Group ? "group" : "private");
         if (type == MessageType::Group) {
-            params["group_id"] = JsonValue(id);
-        } else {
-            params["user_id"] = JsonValue(id);
+            return callAction<SendMsgGroup>("group", id, message, auto_escape);
         }
-        params["message"] = JsonValue(message);
-        params["auto_escape"] = JsonValue(auto_escape);
-        return callApi("send_msg", JsonValue(params));
+        return callAction<SendMsgPrivate>("private", id, message, auto_escape);
     }
     
     std::string deleteMsg(int32_t message_id) {
-        std::map<std::string, JsonValue> params;
-        params["message_id"] = JsonValue(static_cast<int64_t>(message_id));
-        return callApi("delete_msg", JsonValue(params));
+        return callAction<DeleteMsg>(message_id);
     }
     
     std::string getMsg(int32_t message_id) {
-        std::map<std::string, JsonValue> params;
-        params["message_id"] = JsonValue(static_cast<int64_t>(message_id));
-        return callApi("get_msg", JsonValue(params));
+        return callAction<GetMsg>(message_id);
     }
     
     std::string getForwardMsg(const std::string& id) {
-        std::map<std::string, JsonValue> params;
-        params["id"] = JsonValue(id);
-        return callApi("get_forward_msg", JsonValue(params));
+        return callAction<GetForwardMsg>(id);
     }
     
     std::string sendLike(int64_t user_id, int32_t times = 1) {
-        std::map<std::string, JsonValue> params;
-        params["user_id"] = JsonValue(user_id);
-        params["times"] = JsonValue(static_cast<int64_t>(times));
-        return callApi("send_like", JsonValue(params));
+        return callAction<SendLike>(user_id, times);
     }
     
     std::string setGroupKick(int64_t group_id, int64_t user_id, bool reject_add_request = false) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["user_id"] = JsonValue(user_id);
-        params["reject_add_request"] = JsonValue(reject_add_request);
-        return callApi("set_group_kick", JsonValue(params));
+        return callAction<SetGroupKick>(group_id, user_id, reject_add_request);
     }
     
     std::string setGroupBan(int64_t group_id, int64_t user_id, int64_t duration = 1800) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["user_id"] = JsonValue(user_id);
-        params["duration"] = JsonValue(duration);
-        return callApi("set_group_ban", JsonValue(params));
+        return callAction<SetGroupBan>(group_id, user_id, duration);
     }
     
     std::string setGroupWholeBan(int64_t group_id, bool enable = true) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["enable"] = JsonValue(enable);
-        return callApi("set_group_whole_ban", JsonValue(params));
+        return callAction<SetGroupWholeBan>(group_id, enable);
     }
     
     std::string setGroupAdmin(int64_t group_id, int64_t user_id, bool enable = true) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["user_id"] = JsonValue(user_id);
-        params["enable"] = JsonValue(enable);
-        return callApi("set_group_admin", JsonValue(params));
+        return callAction<SetGroupAdmin>(group_id, user_id, enable);
     }
     
     std::string setGroupCard(int64_t group_id, int64_t user_id, const std::string& card) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["user_id"] = JsonValue(user_id);
-        params["card"] = JsonValue(card);
-        return callApi("set_group_card", JsonValue(params));
+        return callAction<SetGroupCard>(group_id, user_id, card);
     }
     
     std::string setGroupName(int64_t group_id, const std::string& group_name) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["group_name"] = JsonValue(group_name);
-        return callApi("set_group_name", JsonValue(params));
+        return callAction<SetGroupName>(group_id, group_name);
     }
     
     std::string setGroupLeave(int64_t group_id, bool is_dismiss = false) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["is_dismiss"] = JsonValue(is_dismiss);
-        return callApi("set_group_leave", JsonValue(params));
+        return callAction<SetGroupLeave>(group_id, is_dismiss);
     }
     
     std::string setGroupSpecialTitle(int64_t group_id, int64_t user_id, const std::string& title, int64_t duration = -1) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["user_id"] = JsonValue(user_id);
-        params["special_title"] = JsonValue(title);
-        params["duration"] = JsonValue(duration);
-        return callApi("set_group_special_title", JsonValue(params));
+        return callAction<SetGroupSpecialTitle>(group_id, user_id, title, duration);
     }
     
     std::string setFriendAddRequest(const std::string& flag, bool approve = true, const std::string& remark = "") {
-        std::map<std::string, JsonValue> params;
-        params["flag"] = JsonValue(flag);
-        params["approve"] = JsonValue(approve);
-        if (!remark.empty()) params["remark"] = JsonValue(remark);
-        return callApi("set_friend_add_request", JsonValue(params));
+        return callAction<SetFriendAddRequest>(flag, approve, optionalText(remark));
     }
     
     std::string setGroupAddRequest(const std::string& flag, const std::string& sub_type, bool approve = true, const std::string& reason = "") {
-        std::map<std::string, JsonValue> params;
-        params["flag"] = JsonValue(flag);
-        params["sub_type"] = JsonValue(sub_type);
-        params["approve"] = JsonValue(approve);
-        if (!reason.empty()) params["reason"] = JsonValue(reason);
-        return callApi("set_group_add_request", JsonValue(params));
+        return callAction<SetGroupAddRequest>(flag, sub_type, approve, optionalText(reason));
     }
     
     std::string getLoginInfo() {
-        return callApi("get_login_info", JsonValue(std::map<std::string, JsonValue>{}));
+        return callAction<GetLoginInfo>();
+    }
+    
+    std::string getLoginInfo(ResponseCallback callback) {
+        return callActionWithCallback<GetLoginInfo>(std::move(callback));
     }
     
     std::string getStrangerInfo(int64_t user_id, bool no_cache = false) {
-        std::map<std::string, JsonValue> params;
-        params["user_id"] = JsonValue(user_id);
-        params["no_cache"] = JsonValue(no_cache);
-        return callApi("get_stranger_info", JsonValue(params));
+        return callAction<GetStrangerInfo>(user_id, no_cache);
     }
     
     std::string getFriendList() {
-        return callApi("get_friend_list", JsonValue(std::map<std::string, JsonValue>{}));
+        return callAction<GetFriendList>();
     }
     
     std::string getGroupInfo(int64_t group_id, bool no_cache = false) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["no_cache"] = JsonValue(no_cache);
-        return callApi("get_group_info", JsonValue(params));
+        return callAction<GetGroupInfo>(group_id, no_cache);
     }
     
     std::string getGroupList() {
-        return callApi("get_group_list", JsonValue(std::map<std::string, JsonValue>{}));
+        return callAction<GetGroupList>();
     }
     
     std::string getGroupMemberInfo(int64_t group_id, int64_t user_id, bool no_cache = false) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["user_id"] = JsonValue(user_id);
-        params["no_cache"] = JsonValue(no_cache);
-        return callApi("get_group_member_info", JsonValue(params));
+        return callAction<GetGroupMemberInfo>(group_id, user_id, no_cache);
     }
     
     std::string getGroupMemberList(int64_t group_id) {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        return callApi("get_group_member_list", JsonValue(params));
+        return callAction<GetGroupMemberList>(group_id);
+    }
+    
+    std::string getGroupMemberList(int64_t group_id, ResponseCallback callback) {
+        return callActionWithCallback<GetGroupMemberList>(std::move(callback), group_id);
     }
     
     std::string getGroupHonorInfo(int64_t group_id, const std::string& type = "all") {
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        params["type"] = JsonValue(type);
-        return callApi("get_group_honor_info", JsonValue(params));
+        return callAction<GetGroupHonorInfo>(group_id, type);
     }
     
     std::string getStatus() {
-        return callApi("get_status", JsonValue(std::map<std::string, JsonValue>{}));
+        return callAction<GetStatus>();
     }
     
     std::string getVersionInfo() {
-        return callApi("get_version_info", JsonValue(std::map<std::string, JsonValue>{}));
+        return callAction<GetVersionInfo>();
     }
     
     std::string canSendImage() {
-        return callApi("can_send_image", JsonValue(std::map<std::string, JsonValue>{}));
+        return callAction<CanSendImage>();
     }
     
     std::string canSendRecord() {
-        return callApi("can_send_record", JsonValue(std::map<std::string, JsonValue>{}));
+        return callAction<CanSendRecord>();
     }
     
     void callApiWithCallback(const std::string& action, const JsonValue& params, ResponseCallback callback) {
-        std::string echo = callApi(action, params);
+        std::string echo = generateEcho();
         if (callback) {
             std::lock_guard<std::mutex> lock(callbacks_mutex_);
             callbacks_[echo] = std::move(callback);
         }
+        sendApi(echo, action, params);
     }
     
     static MessageSegment text(const std::string& text) {
         MessageSegment seg;
         seg.type = "text";
-        seg.data["text"] = text;
+        seg.data[Key::Text] = text;
         return seg;
     }
     
     static MessageSegment face(int32_t id) {
         MessageSegment seg;
         seg.type = "face";
-        seg.data["id"] = std::to_string(id);
+        seg.data[Key::Id] = std::to_string(id);
         return seg;
     }
     
     static MessageSegment image(const std::string& file) {
         MessageSegment seg;
         seg.type = "image";
-        seg.data["file"] = file;
+        seg.data[Key::File] = file;
         return seg;
     }
     
     static MessageSegment record(const std::string& file) {
         MessageSegment seg;
         seg.type = "record";
-        seg.data["file"] = file;
+        seg.data[Key::File] = file;
         return seg;
     }
     
     static MessageSegment at(int64_t qq) {
         MessageSegment seg;
         seg.type = "at";
-        seg.data["qq"] = std::to_string(qq);
+        seg.data[Key::Qq] = std::to_string(qq);
         return seg;
     }
     
     static MessageSegment atAll() {
         MessageSegment seg;
         seg.type = "at";
-        seg.data["qq"] = "all";
+        seg.data[Key::Qq] = "all";
         return seg;
     }
     
     static MessageSegment reply(int32_t id) {
         MessageSegment seg;
         seg.type = "reply";
-        seg.data["id"] = std::to_string(id);
+        seg.data[Key::Id] = std::to_string(id);
         return seg;
     }
     
     static MessageSegment share(const std::string& url, const std::string& title, const std::string& content = "", const std::string& image = "") {
         MessageSegment seg;
         seg.type = "share";
-        seg.data["url"] = url;
-        seg.data["title"] = title;
-        if (!content.empty()) seg.data["content"] = content;
-        if (!image.empty()) seg.data["image"] = image;
+        seg.data[Key::Url] = url;
+        seg.data[Key::Title] = title;
+        if (!content.empty()) seg.data[Key::Content] = content;
+        if (!image.empty()) seg.data[Key::Image] = image;
         return seg;
     }
     
     static MessageSegment json(const std::string& data) {
         MessageSegment seg;
         seg.type = "json";
-        seg.data["data"] = data;
+        seg.data[Key::Data] = data;
         return seg;
     }
     
 private:
-    std::string callApi(const std::string& action, const JsonValue& params) {
+    using SendPrivateMsgText = ActionDescriptor<"send_private_msg", Param<"user_id", int64_t>, Param<"message", std::string_view>, Param<"auto_escape", bool>>;
+    using SendPrivateMsgSegments = ActionDescriptor<"send_private_msg", Param<"user_id", int64_t>, Param<"message", std::vector<MessageSegment>>>;
+    using SendGroupMsgText = ActionDescriptor<"send_group_msg", Param<"group_id", int64_t>, Param<"message", std::string_view>, Param<"auto_escape", bool>>;
+    using SendGroupMsgSegments = ActionDescriptor<"send_group_msg", Param<"group_id", int64_t>, Param<"message", std::vector<MessageSegment>>>;
+    using SendMsgGroup = ActionDescriptor<"send_msg", Param<"message_type", std::string_view>, Param<"group_id", int64_t>, Param<"message", std::string_view>, Param<"auto_escape", bool>>;
+    using SendMsgPrivate = ActionDescriptor<"send_msg", Param<"message_type", std::string_view>, Param<"user_id", int64_t>, Param<"message", std::string_view>, Param<"auto_escape", bool>>;
+    using DeleteMsg = ActionDescriptor<"delete_msg", Param<"message_id", int32_t>>;
+    using GetMsg = ActionDescriptor<"get_msg", Param<"message_id", int32_t>>;
+    using GetForwardMsg = ActionDescriptor<"get_forward_msg", Param<"id", std::string_view>>;
+    using SendLike = ActionDescriptor<"send_like", Param<"user_id", int64_t>, Param<"times", int32_t>>;
+    using SetGroupKick = ActionDescriptor<"set_group_kick", Param<"group_id", int64_t>, Param<"user_id", int64_t>, Param<"reject_add_request", bool>>;
+    using SetGroupBan = ActionDescriptor<"set_group_ban", Param<"group_id", int64_t>, Param<"user_id", int64_t>, Param<"duration", int64_t>>;
+    using SetGroupWholeBan = ActionDescriptor<"set_group_whole_ban", Param<"group_id", int64_t>, Param<"enable", bool>>;
+    using SetGroupAdmin = ActionDescriptor<"set_group_admin", Param<"group_id", int64_t>, Param<"user_id", int64_t>, Param<"enable", bool>>;
+    using SetGroupCard = ActionDescriptor<"set_group_card", Param<"group_id", int64_t>, Param<"user_id", int64_t>, Param<"card", std::string_view>>;
+    using SetGroupName = ActionDescriptor<"set_group_name", Param<"group_id", int64_t>, Param<"group_name", std::string_view>>;
+    using SetGroupLeave = ActionDescriptor<"set_group_leave", Param<"group_id", int64_t>, Param<"is_dismiss", bool>>;
+    using SetGroupSpecialTitle = ActionDescriptor<"set_group_special_title", Param<"group_id", int64_t>, Param<"user_id", int64_t>, Param<"special_title", std::string_view>, Param<"duration", int64_t>>;
+    using SetFriendAddRequest = ActionDescriptor<"set_friend_add_request", Param<"flag", std::string_view>, Param<"approve", bool>, Param<"remark", std::optional<std::string_view>>>;
+    using SetGroupAddRequest = ActionDescriptor<"set_group_add_request", Param<"flag", std::string_view>, Param<"sub_type", std::string_view>, Param<"approve", bool>, Param<"reason", std::optional<std::string_view>>>;
+    using GetLoginInfo = ActionDescriptor<"get_login_info">;
+    using GetStrangerInfo = ActionDescriptor<"get_stranger_info", Param<"user_id", int64_t>, Param<"no_cache", bool>>;
+    using GetFriendList = ActionDescriptor<"get_friend_list">;
+    using GetGroupInfo = ActionDescriptor<"get_group_info", Param<"group_id", int64_t>, Param<"no_cache", bool>>;
+    using GetGroupList = ActionDescriptor<"get_group_list">;
+    using GetGroupMemberInfo = ActionDescriptor<"get_group_member_info", Param<"group_id", int64_t>, Param<"user_id", int64_t>, Param<"no_cache", bool>>;
+    using GetGroupMemberList = ActionDescriptor<"get_group_member_list", Param<"group_id", int64_t>>;
+    using GetGroupHonorInfo = ActionDescriptor<"get_group_honor_info", Param<"group_id", int64_t>, Param<"type", std::string_view>>;
+    using GetStatus = ActionDescriptor<"get_status">;
+    using GetVersionInfo = ActionDescriptor<"get_version_info">;
+    using CanSendImage = ActionDescriptor<"can_send_image">;
+    using CanSendRecord = ActionDescriptor<"can_send_record">;
+    
+    static std::optional<std::string_view> optionalText(const std::string& text) {
+        if (text.empty()) return std::nullopt;
+        return std::string_view(text);
+    }
+    
+    template <typename Action, typename... Args>
+    std::string callAction(const Args&... args) {
         std::string echo = generateEcho();
-        
-        std::map<std::string, JsonValue> request;
-        request["action"] = JsonValue(action);
-        request["params"] = params;
-        request["echo"] = JsonValue(echo);
-        
-        if (send_func_) {
-            std::string json = JsonParser::stringify(JsonValue(request));
-            LOG_INFO("[OneBotApi] Sending: " + json.substr(0, 300));
-            send_func_(json);
+        sendAction<Action>(echo, args...);
+        return echo;
+    }
+    
+    template <typename Action, typename... Args>
+    std::string callActionWithCallback(ResponseCallback callback, const Args&... args) {
+        std::string echo = generateEcho();
+        if (callback) {
+            std::lock_guard<std::mutex> lock(callbacks_mutex_);
+            callbacks_[echo] = std::move(callback);
         }
-        
+        sendAction<Action>(echo, args...);
+        return echo;
+    }
+    
+    template <typename Action, typename... Args>
+    void sendAction(const std::string& echo, const Args&... args) {
+        if (!send_func_) return;
+        thread_local std::string buffer;
+        buffer.clear();
+        Action::write(buffer, echo, args...);
+        LOG_INFO("[OneBotApi] Sending: " + buffer.substr(0, 300));
+        send_func_(buffer);
+    }
+    
+    std::string callApi(const std::string& action, const JsonValue& params) {
+        std::string echo = generateEcho();
+        sendApi(echo, action, params);
         return echo;
     }
     
+    void sendApi(const std::string& echo, const std::string& action, const JsonValue& params) {
+        if (!send_func_) return;
+        thread_local std::string buffer;
+        buffer.clear();
+        JsonWriter writer(buffer);
+        writer.beginObject();
+        writer.field("action", action);
+        writer.field("params", params);
+        writer.field("echo", echo);
+        writer.endObject();
+        LOG_INFO("[OneBotApi] Sending: " + buffer.substr(0, 300));
+        send_func_(buffer);
+    }
+    
+    ResponseCallback takeCallback(const std::string& echo) {
+        std::lock_guard<std::mutex> lock(callbacks_mutex_);
+        auto it = callbacks_.find(echo);
+        if (it == callbacks_.end()) return ResponseCallback();
+        ResponseCallback callback = std::move(it->second);
+        callbacks_.erase(it);
+        return callback;
+    }
+    
     std::string generateEcho() {
         static std::atomic<uint64_t> counter{0};
         return "lchbot_" + std::to_string(++counter);
     }
     
-    JsonValue serializeMessage(const std::vector<MessageSegment>& message) {
-        std::vector<JsonValue> arr;
-        for (const auto& seg : message) {
-            std::map<std::string, JsonValue> seg_obj;
-            seg_obj["type"] = JsonValue(seg.type);
-            std::map<std::string, JsonValue> data_obj;
-            for (const auto& [k, v] : seg.data) {
-                data_obj[k] = JsonValue(v);
-            }
-            seg_obj["data"] = JsonValue(data_obj);
-            arr.push_back(JsonValue(seg_obj));
-        }
-        return JsonValue(arr);
-    }
-    
     SendFunc send_func_;
     std::map<std::string, ResponseCallback> callbacks_;
     std::mutex callbacks_mutex_;
+    inline static thread_local int64_t current_route_ = 0;
 };
 
 }
@@ -5,6 +5,12 @@
 #include "../core/Logger.h"
 #include "../core/Event.h"
 #include "../core/JsonParser.h"
+#include "../core/JsonDocument.h"
+#include "../core/JsonCursor.h"
+#include "../core/FrameArena.h"
+#include "../core/WorkerPool.h"
+#include "../core/KeyedExecutor.h"
+#include "../core/TimerQueue.h"
 #include "../network/WebSocketServer.h"
 #include "../network/WebSocketClient.h"
 #include "../api/OneBotApi.h"
@@ -31,6 +37,11 @@
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <cctype>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "../core/GroupMemberCache.h"
 #include "../core/FileMessageQueue.h"
 
@@ -83,6 +94,24 @@ public:
         RateLimiter::instance().initialize();
         StructuredLogger::instance().initialize(config.log.log_dir, SLogLevel::INFO);
         MetricsExporter::instance().initialize();
+        MetricsExporter::instance().addCustomCollector("allocations", []() {
+            return AllocationStats::instance().exportPrometheus();
+        });
+        MetricsExporter::instance().addCustomCollector("worker_pool", []() {
+            return WorkerPool::instance().exportPrometheus();
+        });
+        dispatcher_ = std::make_unique<KeyedExecutor>(
+            WorkerPool::instance(),
+            config.worker.dispatch_shards,
+            config.worker.queue_capacity,
+            WorkerPool::parsePolicy(config.worker.overflow_policy)
+        );
+        MetricsExporter::instance().addCustomCollector("dispatch", [this]() {
+            return dispatcher_->exportPrometheus();
+        });
+        MetricsExporter::instance().addCustomCollector("ws_deflate", []() {
+            return DeflateStats::instance().exportPrometheus();
+        });
         TraceSystem::instance().initialize(1.0, "lchbot");
         ConfigWatcher::instance().initialize(5000);
         PluginSandbox::instance().initialize();
@@ -110,33 +139,33 @@ public:
             LOG_INFO("  - " + info.name + " v" + info.version + " [" + (plugin_mgr.isPluginEnabled(info.name) ? "enabled" : "disabled") + "]");
         }
         
-        ws_client_ = std::make_unique<WebSocketClient>();
-        
-        ws_client_->setConnectCallback([this]() {
-            LOG_INFO("Connected to LLBot");
-            connected_ = true;
-            api_->getLoginInfo();
-        });
-        
-        ws_client_->setDisconnectCallback([this]() {
-            LOG_WARN("Disconnected from LLBot");
-            connected_ = false;
-            if (running_) {
-                scheduleReconnect();
-            }
-        });
-        
-        ws_client_->setMessageCallback([this](const std::string& message) {
-            handleMessage(0, message);
-        });
-        
-        ws_client_->setErrorCallback([this](const std::string& error) {
-            LOG_ERROR("WebSocket error: " + error);
-        });
+        for (const auto& endpoint : config.endpoints()) {
+            addAccount(endpoint);
+        }
+        LOG_INFO("Configured " + std::to_string(accounts_.size()) + " OneBot account(s)");
+        
+        if (config.reverse.enabled) {
+            reverse_server_ = std::make_unique<WebSocketServer>();
+            reverse_server_->setInlineDispatch(true);
+            reverse_server_->setAccessToken(config.reverse.access_token);
+            reverse_server_->setMaxMessageSize(config.reverse.max_message_size);
+            DeflateOptions deflate;
+            deflate.enabled = config.reverse.compression;
+            deflate.window_bits = static_cast<int>(config.reverse.compression_window_bits);
+            deflate.min_size = config.reverse.compression_min_size;
+            deflate.context_takeover = config.reverse.compression_context_takeover;
+            reverse_server_->setCompression(deflate);
+            reverse_server_->setConnectCallback([this](int client_id) { acceptReverse(client_id); });
+            reverse_server_->setDisconnectCallback([this](int client_id) { releaseReverse(client_id); });
+            reverse_server_->setMessageHandler([this](int client_id, const std::string& message) {
+                auto account = findLink(reverseRoute(client_id));
+                return !account || routeDocument(JsonDocument::adopt(message), *account, false);
+            });
+        }
         
         api_->setSendFunction([this](const std::string& message) {
-            if (ws_client_ && ws_client_->isConnected()) {
-                ws_client_->send(message);
+            if (auto account = resolveRoute(OneBotApi::currentRoute())) {
+                deliver(*account, message);
             }
         });
         
@@ -177,36 +206,22 @@ public:
         }
         
         running_ = true;
-        connectToLLBot();
-        
-        return true;
-    }
-    
-    void connectToLLBot() {
-        const auto& config = ConfigManager::instance().config();
         
-        LOG_INFO("Connecting to LLBot at ws://" + config.websocket.host + ":" + std::to_string(config.websocket.port) + config.websocket.path);
-        
-        if (ws_client_->connect(config.websocket.host, config.websocket.port, config.websocket.path)) {
-            LOG_INFO("Connected to LLBot successfully");
-        } else {
-            LOG_ERROR("Failed to connect to LLBot, will retry...");
-            scheduleReconnect();
+        if (reverse_server_) {
+            const auto& reverse = ConfigManager::instance().config().reverse;
+            if (!reverse_server_->start(reverse.host, reverse.port)) {
+                LOG_ERROR("Failed to listen for OneBot reverse WebSocket on " + reverse.host + ":" + std::to_string(reverse.port));
+                running_ = false;
+                return false;
+            }
+            LOG_INFO("Listening for OneBot reverse WebSocket on ws://" + reverse.host + ":" + std::to_string(reverse.port));
         }
-    }
-    
-    void scheduleReconnect() {
-        if (!running_) return;
         
-        const auto& config = ConfigManager::instance().config();
+        for (auto& account : accounts_) {
+            startConnect(*account);
+        }
         
-        std::thread([this, interval = config.websocket.reconnect_interval]() {
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
-            if (running_ && !connected_) {
-                LOG_INFO("Attempting to reconnect...");
-                connectToLLBot();
-            }
-        }).detach();
+        return true;
     }
     
     void run() {
@@ -227,8 +242,18 @@ public:
         PluginManager::instance().stopHotReload();
         AdminServer::instance().stop();
         
-        if (ws_client_) {
-            ws_client_->disconnect();
+        if (reverse_server_) {
+            reverse_server_->stop();
+        }
+        for (auto& account : accounts_) {
+            TimerQueue::instance().cancel(account->reconnect_timer);
+            std::thread connector;
+            {
+                std::lock_guard<std::mutex> lock(account->connect_mutex);
+                connector = std::move(account->connector);
+            }
+            if (connector.joinable()) connector.join();
+            account->client->disconnect();
         }
         
         PluginManager::instance().unloadAllPlugins();
@@ -276,43 +301,330 @@ public:
         return true;
     }
     
-    void sendGroupMessage(int64_t group_id, const std::string& message) {
+    void sendGroupMessage(int64_t group_id, const std::string& message, int64_t self_id = 0) {
         if (api_) {
+            OneBotApi::RouteScope scope(self_id);
             api_->sendGroupMsg(group_id, message);
         }
     }
     
-    void sendPrivateMessage(int64_t user_id, const std::string& message) {
+    void sendPrivateMessage(int64_t user_id, const std::string& message, int64_t self_id = 0) {
         if (api_) {
+            OneBotApi::RouteScope scope(self_id);
             api_->sendPrivateMsg(user_id, message);
         }
     }
     
+    size_t accountCount() const {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        return links_.size();
+    }
+    
 private:
+    static constexpr int64_t kReverseRouteBase = -(int64_t(1) << 32);
+    
+    struct Account : std::enable_shared_from_this<Account> {
+        int64_t route = 0;
+        int connection_id = 0;
+        bool accepts_api = true;
+        WebSocketConfig config;
+        std::unique_ptr<WebSocketClient> client;
+        std::unique_ptr<Backoff> backoff;
+        std::atomic<int64_t> self_id{0};
+        std::atomic<bool> connected{false};
+        std::atomic<bool> reconnect_pending{false};
+        std::atomic<uint64_t> reconnect_timer{0};
+        std::mutex connect_mutex;
+        std::thread connector;
+        
+        std::string label() const { return config.name.empty() ? "default" : config.name; }
+        
+        std::string metricName() const {
+            std::string name = "ws_link";
+            if (config.name.empty()) return name;
+            name += '_';
+            for (char c : config.name) {
+                name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+            }
+            return name;
+        }
+    };
+    
     Bot() = default;
     ~Bot() { stop(); }
     
-    void handleMessage(int client_id, const std::string& message) {
+    static int64_t reverseRoute(int client_id) { return kReverseRouteBase - client_id; }
+    
+    void addAccount(const WebSocketConfig& endpoint) {
+        auto account = std::make_shared<Account>();
+        account->route = -static_cast<int64_t>(accounts_.size()) - 1;
+        account->config = endpoint;
+        account->client = std::make_unique<WebSocketClient>();
+        account->backoff = std::make_unique<Backoff>(
+            std::chrono::milliseconds(endpoint.reconnect_interval),
+            std::chrono::milliseconds(endpoint.reconnect_max_interval)
+        );
+        
+        Account* self = account.get();
+        WebSocketClient& client = *account->client;
+        client.setInlineDispatch(true);
+        
+        DeflateOptions deflate;
+        deflate.enabled = endpoint.compression;
+        deflate.window_bits = static_cast<int>(endpoint.compression_window_bits);
+        deflate.min_size = endpoint.compression_min_size;
+        deflate.context_takeover = endpoint.compression_context_takeover;
+        client.setCompression(deflate);
+        client.setMaxMessageSize(endpoint.max_message_size);
+        client.setHeartbeat(endpoint.heartbeat_interval, endpoint.heartbeat_timeout);
+        client.setOutageBuffer(endpoint.outage_buffer_size, endpoint.outage_buffer_max_age);
+        client.setPongCallback([](double rtt_seconds) {
+            MetricsExporter::instance().recordWebSocketRtt(rtt_seconds);
+        });
+        MetricsExporter::instance().addCustomCollector(self->metricName(), [self]() {
+            return self->client->exportPrometheus(self->metricName());
+        });
+        
+        client.setConnectCallback([this, self]() {
+            LOG_INFO("[" + self->label() + "] Connected to LLBot");
+            self->connected = true;
+            self->backoff->reset();
+            OneBotApi::RouteScope scope(self->route);
+            api_->getLoginInfo([this, self](const ApiResponse& resp) {
+                if (resp.retcode != 0 || !resp.data.isObject()) return;
+                auto& data = resp.data.asObject();
+                if (data.count("user_id")) {
+                    bindRoute(data.at("user_id").asInt(), *self);
+                }
+            });
+        });
+        
+        client.setDisconnectCallback([this, self]() {
+            LOG_WARN("[" + self->label() + "] Disconnected from LLBot");
+            self->connected = false;
+            if (running_) {
+                scheduleReconnect(*self);
+            }
+        });
+        
+        client.setMessageCallback([this, self](const std::string& message) {
+            handleMessage(*self, message);
+        });
+        
+        client.setDocumentCallback([this, self](std::shared_ptr<JsonDocument> doc) {
+            routeDocument(std::move(doc), *self, true);
+        });
+        
+        client.setErrorCallback([self](const std::string& error) {
+            LOG_ERROR("[" + self->label() + "] WebSocket error: " + error);
+        });
+        
+        {
+            std::lock_guard<std::mutex> lock(routes_mutex_);
+            links_[account->route] = account;
+        }
+        accounts_.push_back(std::move(account));
+    }
+    
+    void acceptReverse(int client_id) {
+        auto account = std::make_shared<Account>();
+        account->route = reverseRoute(client_id);
+        account->connection_id = client_id;
+        account->config.name = "reverse#" + std::to_string(client_id);
+        account->connected = true;
+        
+        std::string role = reverse_server_->requestHeader(client_id, "X-Client-Role");
+        for (auto& c : role) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        account->accepts_api = role != "event";
+        
+        {
+            std::lock_guard<std::mutex> lock(routes_mutex_);
+            links_[account->route] = account;
+        }
+        MetricsExporter::instance().setActiveConnections(static_cast<int>(reverse_server_->clientCount()));
+        LOG_INFO("[" + account->label() + "] OneBot implementation connected" + (role.empty() ? "" : " (role " + role + ")"));
+        
+        std::string self_id = reverse_server_->requestHeader(client_id, "X-Self-ID");
+        if (!self_id.empty()) {
+            try {
+                bindRoute(std::stoll(self_id), *account);
+            } catch (const std::exception&) {
+                LOG_WARN("[" + account->label() + "] Ignoring malformed X-Self-ID: " + self_id);
+            }
+        }
+    }
+    
+    void releaseReverse(int client_id) {
+        std::shared_ptr<Account> account;
+        {
+            std::lock_guard<std::mutex> lock(routes_mutex_);
+            auto it = links_.find(reverseRoute(client_id));
+            if (it == links_.end()) return;
+            account = std::move(it->second);
+            links_.erase(it);
+            auto route = routes_.find(account->self_id);
+            if (route != routes_.end() && route->second == account) {
+                routes_.erase(route);
+            }
+        }
+        account->connected = false;
+        MetricsExporter::instance().setActiveConnections(static_cast<int>(reverse_server_->clientCount()));
+        LOG_WARN("[" + account->label() + "] OneBot implementation disconnected");
+    }
+    
+    void deliver(Account& account, const std::string& message) {
+        if (account.client) {
+            account.client->send(message);
+        } else if (reverse_server_) {
+            reverse_server_->send(account.connection_id, message);
+        }
+    }
+    
+    void connectToLLBot(Account& account) {
+        const auto& endpoint = account.config;
+        
+        LOG_INFO("[" + account.label() + "] Connecting to LLBot at ws://" + endpoint.host + ":" + std::to_string(endpoint.port) + endpoint.path);
+        
+        if (account.client->connect(endpoint.host, endpoint.port, endpoint.path)) {
+            LOG_INFO("[" + account.label() + "] Connected to LLBot successfully");
+        } else {
+            LOG_ERROR("[" + account.label() + "] Failed to connect to LLBot, will retry...");
+            scheduleReconnect(account);
+        }
+    }
+    
+    void startConnect(Account& account) {
+        std::lock_guard<std::mutex> lock(account.connect_mutex);
+        if (!running_ || account.connected) return;
+        if (account.connector.joinable()) account.connector.join();
+        account.connector = std::thread([this, &account]() {
+            connectToLLBot(account);
+        });
+    }
+    
+    void scheduleReconnect(Account& account) {
+        if (!running_ || account.reconnect_pending.exchange(true)) return;
+        
+        auto delay = account.backoff->next();
+        LOG_INFO("[" + account.label() + "] Reconnecting in " + std::to_string(delay.count()) + "ms (attempt " + std::to_string(account.backoff->attempts()) + ")");
+        
+        account.reconnect_timer = TimerQueue::instance().schedule(delay, [this, &account]() {
+            account.reconnect_pending = false;
+            if (running_ && !account.connected) {
+                LOG_INFO("[" + account.label() + "] Attempting to reconnect...");
+                MetricsExporter::instance().recordReconnectAttempt();
+                startConnect(account);
+            }
+        });
+    }
+    
+    void bindRoute(int64_t self_id, Account& account) {
+        if (self_id <= 0 || account.self_id.load(std::memory_order_relaxed) == self_id) return;
+        {
+            std::lock_guard<std::mutex> lock(routes_mutex_);
+            int64_t previous = account.self_id.exchange(self_id);
+            if (!account.accepts_api) return;
+            auto it = routes_.find(previous);
+            if (it != routes_.end() && it->second.get() == &account) {
+                routes_.erase(it);
+            }
+            routes_[self_id] = account.shared_from_this();
+        }
+        LOG_INFO("[" + account.label() + "] Serving account " + std::to_string(self_id));
+    }
+    
+    std::shared_ptr<Account> findLink(int64_t route) {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        auto it = links_.find(route);
+        return it == links_.end() ? nullptr : it->second;
+    }
+    
+    std::shared_ptr<Account> resolveRoute(int64_t route) {
+        if (route < 0) return findLink(route);
+        if (route == 0) {
+            if (!accounts_.empty()) return accounts_.front();
+            std::lock_guard<std::mutex> lock(routes_mutex_);
+            return routes_.empty() ? nullptr : routes_.begin()->second;
+        }
+        
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        auto it = routes_.find(route);
+        if (it == routes_.end()) {
+            LOG_WARN("[Bot] No connection serves account " + std::to_string(route) + ", dropping outbound action");
+            return nullptr;
+        }
+        return it->second;
+    }
+    
+    void handleMessage(Account& account, const std::string& message) {
+        routeDocument(JsonDocument::adopt(message), account, true);
+    }
+    
+    bool routeDocument(std::shared_ptr<const JsonDocument> doc, Account& account, bool may_wait) {
+        bool response = false;
+        int64_t self_id = 0;
+        int64_t group_id = 0;
+        int64_t user_id = 0;
         try {
-            JsonValue json = JsonParser::parse(message);
-            
-            if (!json.isObject()) return;
-            const auto& obj = json.asObject();
-            
-            if (obj.find("echo") != obj.end()) {
-                api_->handleResponse(json);
+            JsonCursor json(doc->buffer());
+            if (!json.isObject()) return true;
+            json.forEachField([&](std::string_view name, const JsonCursor& value) {
+                switch (KeyTable::lookup(name)) {
+                    case Key::Echo: response = true; break;
+                    case Key::SelfId: self_id = value.getInt64().value_or(0); break;
+                    case Key::GroupId: group_id = value.getInt64().value_or(0); break;
+                    case Key::UserId: user_id = value.getInt64().value_or(0); break;
+                    default: break;
+                }
+            });
+        } catch (const std::exception& e) {
+            LOG_ERROR("Failed to route message: " + std::string(e.what()));
+            return true;
+        }
+        
+        bindRoute(self_id, account);
+        int64_t route = self_id > 0 ? self_id : account.route;
+        auto task = [this, doc, route, response]() {
+            OneBotApi::RouteScope scope(route);
+            handleDocument(doc, response);
+        };
+        bool accepted;
+        bool holds = false;
+        if (response) {
+            accepted = WorkerPool::instance().post(std::move(task));
+        } else if (group_id == 0 && user_id == 0) {
+            WorkerPool& pool = WorkerPool::instance();
+            accepted = may_wait ? pool.submit(std::move(task)) : pool.trySubmit(std::move(task));
+            holds = pool.appliesBackpressure();
+        } else {
+            uint64_t key = group_id != 0 ? KeyedExecutor::groupKey(group_id) : KeyedExecutor::privateKey(user_id);
+            accepted = may_wait ? dispatcher_->submit(key, std::move(task)) : dispatcher_->trySubmit(key, std::move(task));
+            holds = dispatcher_->appliesBackpressure();
+        }
+        if (!accepted && !may_wait && holds) return false;
+        if (!accepted) {
+            LOG_WARN("[Bot] Dispatch queue full, dropping inbound event");
+        }
+        return true;
+    }
+    
+    void handleDocument(std::shared_ptr<const JsonDocument> doc, bool response) {
+        FrameAllocationScope allocation_scope;
+        try {
+            if (response) {
+                api_->handleResponse(doc);
                 return;
             }
             
-            auto event = EventParser::parse(json);
+            EventPtr event = EventParser::parse(doc);
             if (!event) return;
             
             auto& plugin_mgr = PluginManager::instance();
             
             switch (event->type) {
                 case EventType::Message: {
-                    auto* msg_event = static_cast<MessageEvent*>(event.get());
-                    std::string sender_name = msg_event->sender.card.empty() ? msg_event->sender.nickname : msg_event->sender.card;
+                    auto* msg_event = static_cast<const MessageEvent*>(event.get());
+                    const std::string& sender_name = msg_event->senderName();
                     if (msg_event->isGroup()) {
                         LOG_MSG("[Group:" + std::to_string(msg_event->group_id) + "] " + sender_name + "(" + std::to_string(msg_event->user_id) + "): " + msg_event->raw_message);
                         
@@ -333,17 +645,17 @@ private:
                     break;
                 }
                 case EventType::Notice: {
-                    auto* notice_event = static_cast<NoticeEvent*>(event.get());
+                    auto* notice_event = static_cast<const NoticeEvent*>(event.get());
                     plugin_mgr.dispatchNotice(*notice_event);
                     break;
                 }
                 case EventType::Request: {
-                    auto* request_event = static_cast<RequestEvent*>(event.get());
+                    auto* request_event = static_cast<const RequestEvent*>(event.get());
                     plugin_mgr.dispatchRequest(*request_event);
                     break;
                 }
                 case EventType::Meta: {
-                    auto* meta_event = static_cast<MetaEvent*>(event.get());
+                    auto* meta_event = static_cast<const MetaEvent*>(event.get());
                     if (meta_event->meta_event_type == MetaEventType::Lifecycle) {
                         LOG_INFO("Lifecycle event: " + meta_event->sub_type);
                     } else if (meta_event->meta_event_type == MetaEventType::Heartbeat) {
@@ -367,10 +679,7 @@ private:
         
         cache.markPending(group_id);
         
-        std::map<std::string, JsonValue> params;
-        params["group_id"] = JsonValue(group_id);
-        
-        api_->callApiWithCallback("get_group_member_list", JsonValue(params),
+        api_->getGroupMemberList(group_id,
             [group_id](const ApiResponse& member_resp) {
                 if (member_resp.retcode != 0 || !member_resp.data.isArray()) return;
                 
@@ -394,13 +703,17 @@ private:
             });
     }
     
-    std::unique_ptr<WebSocketClient> ws_client_;
+    std::vector<std::shared_ptr<Account>> accounts_;
+    std::unordered_map<int64_t, std::shared_ptr<Account>> links_;
+    std::map<int64_t, std::shared_ptr<Account>> routes_;
+    mutable std::mutex routes_mutex_;
+    std::unique_ptr<WebSocketServer> reverse_server_;
+    std::unique_ptr<KeyedExecutor> dispatcher_;
     std::unique_ptr<OneBotApi> api_;
     std::unique_ptr<PluginContext> context_;
     
     std::atomic<bool> initialized_{false};
     std::atomic<bool> running_{false};
-    std::atomic<bool> connected_{false};
 };
 
 }
@@ -10,6 +10,7 @@
 namespace LCHBOT {
 
 struct WebSocketConfig {
+    std::string name;
     std::string host = "127.0.0.1";
     uint16_t port = 3001;
     std::string path = "/";
@@ -17,6 +18,27 @@ struct WebSocketConfig {
     uint32_t heartbeat_interval = 60000;
     uint32_t reconnect_interval = 5000;
     uint32_t max_reconnect_attempts = 10;
+    bool compression = false;
+    uint32_t compression_window_bits = 15;
+    uint32_t compression_min_size = 1024;
+    bool compression_context_takeover = true;
+    uint32_t max_message_size = 64 * 1024 * 1024;
+    uint32_t heartbeat_timeout = 180000;
+    uint32_t reconnect_max_interval = 60000;
+    uint32_t outage_buffer_size = 1000;
+    uint32_t outage_buffer_max_age = 300000;
+};
+
+struct ReverseWebSocketConfig {
+    bool enabled = false;
+    std::string host = "0.0.0.0";
+    uint16_t port = 6700;
+    std::string access_token;
+    bool compression = false;
+    uint32_t compression_window_bits = 15;
+    uint32_t compression_min_size = 1024;
+    bool compression_context_takeover = true;
+    uint32_t max_message_size = 64 * 1024 * 1024;
 };
 
 struct PluginConfig {
@@ -41,15 +63,32 @@ struct AIConfig {
     std::string api_key;
 };
 
+struct WorkerConfig {
+    uint32_t threads = 0;
+    uint32_t queue_capacity = 1024;
+    std::string overflow_policy = "block";
+    uint32_t dispatch_shards = 0;
+};
+
 struct BotConfig {
     WebSocketConfig websocket;
+    ReverseWebSocketConfig reverse;
+    WorkerConfig worker;
     PluginConfig plugin;
     LogConfig log;
     AIConfig ai;
     std::string data_dir = "data";
     std::string config_file = "config.ini";
+    std::string internal_format = "json";
     int admin_port = 8080;
     std::vector<int64_t> master_qq;
+    std::vector<WebSocketConfig> accounts;
+    
+    std::vector<WebSocketConfig> endpoints() const {
+        if (!accounts.empty()) return accounts;
+        if (reverse.enabled) return {};
+        return {websocket};
+    }
 };
 
 class ConfigManager {
@@ -65,6 +104,7 @@ public:
         if (!file.is_open()) {
             return createDefault(path);
         }
+        config_.accounts.clear();
         
         std::string line;
         std::string section;
@@ -98,14 +138,28 @@ public:
         std::ofstream file(path);
         if (!file.is_open()) return false;
         
-        file << "[websocket]\n";
-        file << "host=" << config_.websocket.host << "\n";
-        file << "port=" << config_.websocket.port << "\n";
-        file << "path=" << config_.websocket.path << "\n";
-        file << "token=" << config_.websocket.token << "\n";
-        file << "heartbeat_interval=" << config_.websocket.heartbeat_interval << "\n";
-        file << "reconnect_interval=" << config_.websocket.reconnect_interval << "\n";
-        file << "max_reconnect_attempts=" << config_.websocket.max_reconnect_attempts << "\n";
+        writeWebSocket(file, "websocket", config_.websocket);
+        for (const auto& account : config_.accounts) {
+            writeWebSocket(file, "websocket." + account.name, account);
+        }
+        
+        file << "[reverse]\n";
+        file << "enabled=" << (config_.reverse.enabled ? "true" : "false") << "\n";
+        file << "host=" << config_.reverse.host << "\n";
+        file << "port=" << config_.reverse.port << "\n";
+        file << "access_token=" << config_.reverse.access_token << "\n";
+        file << "compression=" << (config_.reverse.compression ? "true" : "false") << "\n";
+        file << "compression_window_bits=" << config_.reverse.compression_window_bits << "\n";
+        file << "compression_min_size=" << config_.reverse.compression_min_size << "\n";
+        file << "compression_context_takeover=" << (config_.reverse.compression_context_takeover ? "true" : "false") << "\n";
+        file << "max_message_size=" << config_.reverse.max_message_size << "\n";
+        file << "\n";
+        
+        file << "[worker]\n";
+        file << "threads=" << config_.worker.threads << "\n";
+        file << "queue_capacity=" << config_.worker.queue_capacity << "\n";
+        file << "overflow_policy=" << config_.worker.overflow_policy << "\n";
+        file << "dispatch_shards=" << config_.worker.dispatch_shards << "\n";
         file << "\n";
         
         file << "[plugin]\n";
@@ -127,6 +181,7 @@ public:
         file << "[general]\n";
         file << "data_dir=" << config_.data_dir << "\n";
         file << "admin_port=" << config_.admin_port << "\n";
+        file << "internal_format=" << config_.internal_format << "\n";
         if (!config_.master_qq.empty()) {
             file << "master_qq=";
             for (size_t i = 0; i < config_.master_qq.size(); ++i) {
@@ -155,13 +210,27 @@ private:
     
     void parseValue(const std::string& section, const std::string& key, const std::string& value) {
         if (section == "websocket") {
-            if (key == "host") config_.websocket.host = value;
-            else if (key == "port") config_.websocket.port = static_cast<uint16_t>(std::stoi(value));
-            else if (key == "path") config_.websocket.path = value;
-            else if (key == "token") config_.websocket.token = value;
-            else if (key == "heartbeat_interval") config_.websocket.heartbeat_interval = std::stoul(value);
-            else if (key == "reconnect_interval") config_.websocket.reconnect_interval = std::stoul(value);
-            else if (key == "max_reconnect_attempts") config_.websocket.max_reconnect_attempts = std::stoul(value);
+            parseWebSocket(config_.websocket, key, value);
+        }
+        else if (section.rfind("websocket.", 0) == 0) {
+            parseWebSocket(account(section.substr(10)), key, value);
+        }
+        else if (section == "reverse") {
+            if (key == "enabled") config_.reverse.enabled = (value == "true" || value == "1");
+            else if (key == "host") config_.reverse.host = value;
+            else if (key == "port") config_.reverse.port = static_cast<uint16_t>(std::stoi(value));
+            else if (key == "access_token") config_.reverse.access_token = value;
+            else if (key == "compression") config_.reverse.compression = (value == "true" || value == "1");
+            else if (key == "compression_window_bits") config_.reverse.compression_window_bits = std::stoul(value);
+            else if (key == "compression_min_size") config_.reverse.compression_min_size = std::stoul(value);
+            else if (key == "compression_context_takeover") config_.reverse.compression_context_takeover = (value == "true" || value == "1");
+            else if (key == "max_message_size") config_.reverse.max_message_size = std::stoul(value);
+        }
+        else if (section == "worker") {
+            if (key == "threads") config_.worker.threads = std::stoul(value);
+            else if (key == "queue_capacity") config_.worker.queue_capacity = std::stoul(value);
+            else if (key == "overflow_policy") config_.worker.overflow_policy = value;
+            else if (key == "dispatch_shards") config_.worker.dispatch_shards = std::stoul(value);
         }
         else if (section == "plugin") {
             if (key == "plugins_dir") config_.plugin.plugins_dir = value;
@@ -180,6 +249,7 @@ private:
         else if (section == "general") {
             if (key == "data_dir") config_.data_dir = value;
             else if (key == "admin_port") config_.admin_port = std::stoi(value);
+            else if (key == "internal_format") config_.internal_format = value;
             else if (key == "master_qq") {
                 config_.master_qq.clear();
                 std::stringstream ss(value);
@@ -198,6 +268,56 @@ private:
         }
     }
     
+    WebSocketConfig& account(const std::string& name) {
+        for (auto& account : config_.accounts) {
+            if (account.name == name) return account;
+        }
+        WebSocketConfig account = config_.websocket;
+        account.name = name;
+        config_.accounts.push_back(std::move(account));
+        return config_.accounts.back();
+    }
+    
+    static void writeWebSocket(std::ofstream& file, const std::string& section, const WebSocketConfig& ws) {
+        file << "[" << section << "]\n";
+        file << "host=" << ws.host << "\n";
+        file << "port=" << ws.port << "\n";
+        file << "path=" << ws.path << "\n";
+        file << "token=" << ws.token << "\n";
+        file << "heartbeat_interval=" << ws.heartbeat_interval << "\n";
+        file << "reconnect_interval=" << ws.reconnect_interval << "\n";
+        file << "max_reconnect_attempts=" << ws.max_reconnect_attempts << "\n";
+        file << "compression=" << (ws.compression ? "true" : "false") << "\n";
+        file << "compression_window_bits=" << ws.compression_window_bits << "\n";
+        file << "compression_min_size=" << ws.compression_min_size << "\n";
+        file << "compression_context_takeover=" << (ws.compression_context_takeover ? "true" : "false") << "\n";
+        file << "max_message_size=" << ws.max_message_size << "\n";
+        file << "heartbeat_timeout=" << ws.heartbeat_timeout << "\n";
+        file << "reconnect_max_interval=" << ws.reconnect_max_interval << "\n";
+        file << "outage_buffer_size=" << ws.outage_buffer_size << "\n";
+        file << "outage_buffer_max_age=" << ws.outage_buffer_max_age << "\n";
+        file << "\n";
+    }
+    
+    static void parseWebSocket(WebSocketConfig& ws, const std::string& key, const std::string& value) {
+        if (key == "host") ws.host = value;
+        else if (key == "port") ws.port = static_cast<uint16_t>(std::stoi(value));
+        else if (key == "path") ws.path = value;
+        else if (key == "token") ws.token = value;
+        else if (key == "heartbeat_interval") ws.heartbeat_interval = std::stoul(value);
+        else if (key == "reconnect_interval") ws.reconnect_interval = std::stoul(value);
+        else if (key == "max_reconnect_attempts") ws.max_reconnect_attempts = std::stoul(value);
+        else if (key == "compression") ws.compression = (value == "true" || value == "1");
+        else if (key == "compression_window_bits") ws.compression_window_bits = std::stoul(value);
+        else if (key == "compression_min_size") ws.compression_min_size = std::stoul(value);
+        else if (key == "compression_context_takeover") ws.compression_context_takeover = (value == "true" || value == "1");
+        else if (key == "max_message_size") ws.max_message_size = std::stoul(value);
+        else if (key == "heartbeat_timeout") ws.heartbeat_timeout = std::stoul(value);
+        else if (key == "reconnect_max_interval") ws.reconnect_max_interval = std::stoul(value);
+        else if (key == "outage_buffer_size") ws.outage_buffer_size = std::stoul(value);
+        else if (key == "outage_buffer_max_age") ws.outage_buffer_max_age = std::stoul(value);
+    }
+    
     std::string trim(const std::string& s) {
         auto start = s.find_first_not_of(" \t\r\n");
         if (start == std::string::npos) return "";
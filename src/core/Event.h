@@ -2,6 +2,10 @@
 
 #include "Types.h"
 #include "JsonParser.h"
+#include "JsonDocument.h"
+#include "JsonCursor.h"
+#include "JsonWriter.h"
+#include "TextEscape.h"
 #include <functional>
 #include <vector>
 #include <map>
@@ -11,13 +15,37 @@
 
 namespace LCHBOT {
 
-class Event {
+template <typename T>
+class LazyValue {
+public:
+    LazyValue() = default;
+    LazyValue(const LazyValue&) {}
+    LazyValue& operator=(const LazyValue&) { return *this; }
+    
+    template <typename F>
+    const T& get(F&& compute) const {
+        std::call_once(once_, [&] { value_ = compute(); });
+        return value_;
+    }
+    
+private:
+    mutable std::once_flag once_;
+    mutable T value_{};
+};
+
+class Event : public std::enable_shared_from_this<Event> {
 public:
     EventType type = EventType::Unknown;
     int64_t time = 0;
     int64_t self_id = 0;
     std::string post_type;
     JsonValue raw_data;
+    std::shared_ptr<const JsonDocument> document;
+    
+    JsonValue raw() const {
+        if (!raw_data.isNull() || !document) return raw_data;
+        return document->root().toValue();
+    }
     
     virtual ~Event() = default;
 };
@@ -39,20 +67,88 @@ public:
     bool isPrivate() const { return message_type == MessageType::Private; }
     bool isGroup() const { return message_type == MessageType::Group; }
     
-    std::string getText() const {
-        std::string text;
-        for (const auto& seg : message) {
-            if (seg.type == "text") {
-                auto it = seg.data.find("text");
-                if (it != seg.data.end()) {
-                    text += it->second;
+    const std::string& getText() const {
+        return text_.get([this] {
+            std::string text;
+            for (const auto& seg : message) {
+                if (seg.type == "text") {
+                    auto it = seg.data.find(Key::Text);
+                    if (it != seg.data.end()) {
+                        text.append(it->second.data(), it->second.size());
+                    }
+                }
+            }
+            return text;
+        });
+    }
+    
+    const std::string& senderName() const {
+        return sender_name_.get([this] {
+            return sender.card.empty() ? sender.nickname : sender.card;
+        });
+    }
+    
+    const std::string& toJson() const {
+        return json_.get([this] {
+            JsonWriter writer;
+            writer.reserve(256 + raw_message.size() * 2);
+            writer.beginObject();
+            writer.field("message_type", isGroup() ? "group" : "private");
+            writer.field("sub_type", sub_type);
+            writer.field("message_id", message_id);
+            writer.field("user_id", user_id);
+            writer.field("group_id", group_id);
+            writer.field("raw_message", raw_message);
+            writer.field("time", time);
+            writer.field("self_id", self_id);
+            
+            writer.key("sender").beginObject();
+            writer.field("user_id", sender.user_id);
+            writer.field("nickname", sender.nickname);
+            writer.field("card", sender.card);
+            writer.field("role", sender.role);
+            writer.endObject();
+            
+            writer.key("message").beginArray();
+            for (const auto& seg : message) {
+                writer.beginObject();
+                writer.field("type", std::string_view(seg.type));
+                writer.key("data").beginObject();
+                for (const auto& [k, v] : seg.data) {
+                    writer.field(k, std::string_view(v));
                 }
+                writer.endObject();
+                writer.endObject();
             }
+            writer.endArray();
+            writer.endObject();
+            return writer.take();
+        });
+    }
+    
+    const std::string& toPythonLiteral() const {
+        return python_literal_.get([this] {
+            return TextEscape::pythonLiteral(toJson(), '"');
+        });
+    }
+    
+    std::shared_ptr<const MessageEvent> share() const {
+        if (auto self = weak_from_this().lock()) {
+            return std::static_pointer_cast<const MessageEvent>(self);
         }
-        return text;
+        return std::make_shared<const MessageEvent>(*this);
     }
+    
+private:
+    LazyValue<std::string> text_;
+    LazyValue<std::string> sender_name_;
+    LazyValue<std::string> json_;
+    LazyValue<std::string> python_literal_;
 };
 
+using EventPtr = std::shared_ptr<const Event>;
+using MessageEventPtr = std::shared_ptr<const MessageEvent>;
+
 class NoticeEvent : public Event {
 public:
     NoticeEvent() { type = EventType::Notice; }
@@ -85,8 +181,18 @@ public:
     
     MetaEventType meta_event_type = MetaEventType::Unknown;
     std::string sub_type;
-    JsonValue status;
+    JsonValue status_data;
     int64_t interval = 0;
+    
+    const JsonValue& status() const {
+        return status_.get([this] {
+            if (!status_data.isNull() || !document) return status_data;
+            return document->root().find(Key::Status).toValue();
+        });
+    }
+    
+private:
+    LazyValue<JsonValue> status_;
 };
 
 class EventParser {
@@ -96,7 +202,7 @@ public:
         
         const auto& obj = json.asObject();
         
-        auto post_type_it = obj.find("post_type");
+        auto post_type_it = obj.find(Key::PostType);
         if (post_type_it == obj.end()) return nullptr;
         
         std::string post_type = post_type_it->second.asString();
@@ -119,18 +225,232 @@ public:
             event->raw_data = json;
             event->post_type = post_type;
             
-            if (obj.find("time") != obj.end()) {
-                event->time = obj.at("time").asInt();
+            auto time_it = obj.find(Key::Time);
+            if (time_it != obj.end()) {
+                event->time = time_it->second.asInt();
             }
-            if (obj.find("self_id") != obj.end()) {
-                event->self_id = obj.at("self_id").asInt();
+            auto self_id_it = obj.find(Key::SelfId);
+            if (self_id_it != obj.end()) {
+                event->self_id = self_id_it->second.asInt();
             }
         }
         
         return event;
     }
     
+    static std::unique_ptr<Event> parse(const std::shared_ptr<const JsonDocument>& doc) {
+        if (!doc) return nullptr;
+        
+        JsonCursor json(doc->buffer());
+        if (!json.isObject()) return nullptr;
+        
+        auto post_type_v = json.findField(Key::PostType).getStringView();
+        if (!post_type_v) return nullptr;
+        
+        std::string_view post_type = *post_type_v;
+        
+        std::unique_ptr<Event> event;
+        
+        if (post_type == "message" || post_type == "message_sent") {
+            event = parseMessageEvent(json, doc->resource());
+        } else if (post_type == "notice") {
+            event = parseNoticeEvent(json);
+        } else if (post_type == "request") {
+            event = parseRequestEvent(json);
+        } else if (post_type == "meta_event") {
+            event = parseMetaEvent(json);
+        } else {
+            event = std::make_unique<Event>();
+            json.forEachField([&](std::string_view key, const JsonCursor& v) {
+                readCommonField(*event, KeyTable::lookup(key), v);
+            });
+        }
+        
+        if (event) {
+            event->document = doc;
+            event->post_type = std::string(post_type);
+        }
+        
+        return event;
+    }
+    
 private:
+    static bool readCommonField(Event& event, Key key, const JsonCursor& v) {
+        switch (key) {
+            case Key::Time: event.time = v.getInt64(0); return true;
+            case Key::SelfId: event.self_id = v.getInt64(0); return true;
+            default: return false;
+        }
+    }
+    
+    template <typename String>
+    static void assignString(String& out, const JsonCursor& v) {
+        if (auto view = v.getStringView()) {
+            out.assign(view->data(), view->size());
+        } else if (v.isString()) {
+            out.clear();
+            JsonDocument::appendUnescaped(v.raw().substr(1, v.raw().size() - 2), out);
+        }
+    }
+    
+    static void parseSegmentData(MessageSegment& segment, const JsonCursor& data) {
+        auto* resource = segment.data.get_allocator().resource();
+        data.forEachField([&](std::string_view k, const JsonCursor& v) {
+            std::pmr::string value(resource);
+            if (v.isString()) {
+                assignString(value, v);
+            } else if (v.isNumber()) {
+                value.assign(v.raw().data(), v.raw().size());
+            } else if (v.isBool()) {
+                value = *v.getBool() ? "true" : "false";
+            } else {
+                return;
+            }
+            segment.data.emplace(k, std::move(value));
+        });
+    }
+    
+    static std::unique_ptr<MessageEvent> parseMessageEvent(const JsonCursor& json, std::pmr::memory_resource* resource) {
+        auto event = std::make_unique<MessageEvent>();
+        
+        json.forEachField([&](std::string_view name, const JsonCursor& v) {
+            Key key = KeyTable::lookup(name);
+            if (readCommonField(*event, key, v)) return;
+            
+            switch (key) {
+                case Key::MessageType:
+                    event->message_type = (v.getStringView() == std::string_view("group")) ? MessageType::Group : MessageType::Private;
+                    break;
+                case Key::SubType: assignString(event->sub_type, v); break;
+                case Key::MessageId: event->message_id = static_cast<int32_t>(v.getInt64(0)); break;
+                case Key::UserId: event->user_id = v.getInt64(0); break;
+                case Key::GroupId: event->group_id = v.getInt64(0); break;
+                case Key::RawMessage: assignString(event->raw_message, v); break;
+                case Key::Font: event->font = static_cast<int32_t>(v.getInt64(0)); break;
+                case Key::Message:
+                    if (v.isArray()) {
+                        v.forEachElement([&](const JsonCursor& seg) {
+                            if (!seg.isObject()) return;
+                            MessageSegment segment(resource);
+                            seg.forEachField([&](std::string_view sk, const JsonCursor& sv) {
+                                Key seg_key = KeyTable::lookup(sk);
+                                if (seg_key == Key::Type) {
+                                    assignString(segment.type, sv);
+                                } else if (seg_key == Key::Data && sv.isObject()) {
+                                    parseSegmentData(segment, sv);
+                                }
+                            });
+                            event->message.push_back(std::move(segment));
+                        });
+                    } else if (v.isString()) {
+                        MessageSegment seg(resource);
+                        seg.type = "text";
+                        std::pmr::string text(resource);
+                        assignString(text, v);
+                        seg.data.emplace(Key::Text, std::move(text));
+                        event->message.push_back(std::move(seg));
+                    }
+                    break;
+                case Key::Sender:
+                    if (v.isObject()) parseSender(event->sender, v);
+                    break;
+                default:
+                    break;
+            }
+        });
+        
+        return event;
+    }
+    
+    static void parseSender(Sender& sender, const JsonCursor& json) {
+        json.forEachField([&](std::string_view name, const JsonCursor& v) {
+            switch (KeyTable::lookup(name)) {
+                case Key::UserId: sender.user_id = v.getInt64(0); break;
+                case Key::Nickname: assignString(sender.nickname, v); break;
+                case Key::Card: assignString(sender.card, v); break;
+                case Key::Sex: assignString(sender.sex, v); break;
+                case Key::Age: sender.age = static_cast<int32_t>(v.getInt64(0)); break;
+                case Key::Area: assignString(sender.area, v); break;
+                case Key::Level: assignString(sender.level, v); break;
+                case Key::Role: assignString(sender.role, v); break;
+                case Key::Title: assignString(sender.title, v); break;
+                default: break;
+            }
+        });
+    }
+    
+    static std::unique_ptr<NoticeEvent> parseNoticeEvent(const JsonCursor& json) {
+        auto event = std::make_unique<NoticeEvent>();
+        
+        json.forEachField([&](std::string_view name, const JsonCursor& v) {
+            Key key = KeyTable::lookup(name);
+            if (readCommonField(*event, key, v)) return;
+            
+            if (key == Key::NoticeType) {
+                std::string_view nt = v.getStringView().value_or("");
+                if (nt == "group_upload") event->notice_type = NoticeType::GroupUpload;
+                else if (nt == "group_admin") event->notice_type = NoticeType::GroupAdmin;
+                else if (nt == "group_decrease") event->notice_type = NoticeType::GroupDecrease;
+                else if (nt == "group_increase") event->notice_type = NoticeType::GroupIncrease;
+                else if (nt == "group_ban") event->notice_type = NoticeType::GroupBan;
+                else if (nt == "friend_add") event->notice_type = NoticeType::FriendAdd;
+                else if (nt == "group_recall") event->notice_type = NoticeType::GroupRecall;
+                else if (nt == "friend_recall") event->notice_type = NoticeType::FriendRecall;
+                else if (nt == "notify") event->notice_type = NoticeType::Notify;
+            }
+            else if (key == Key::SubType) assignString(event->sub_type, v);
+            else if (key == Key::GroupId) event->group_id = v.getInt64(0);
+            else if (key == Key::UserId) event->user_id = v.getInt64(0);
+            else if (key == Key::OperatorId) event->operator_id = v.getInt64(0);
+            else if (key == Key::TargetId) event->target_id = v.getInt64(0);
+            else if (key == Key::Duration) event->duration = v.getInt64(0);
+            else if (key == Key::MessageId) event->message_id = static_cast<int32_t>(v.getInt64(0));
+        });
+        
+        return event;
+    }
+    
+    static std::unique_ptr<RequestEvent> parseRequestEvent(const JsonCursor& json) {
+        auto event = std::make_unique<RequestEvent>();
+        
+        json.forEachField([&](std::string_view name, const JsonCursor& v) {
+            Key key = KeyTable::lookup(name);
+            if (readCommonField(*event, key, v)) return;
+            
+            if (key == Key::RequestType) {
+                std::string_view rt = v.getStringView().value_or("");
+                if (rt == "friend") event->request_type = RequestType::Friend;
+                else if (rt == "group") event->request_type = RequestType::Group;
+            }
+            else if (key == Key::SubType) assignString(event->sub_type, v);
+            else if (key == Key::UserId) event->user_id = v.getInt64(0);
+            else if (key == Key::GroupId) event->group_id = v.getInt64(0);
+            else if (key == Key::Comment) assignString(event->comment, v);
+            else if (key == Key::Flag) assignString(event->flag, v);
+        });
+        
+        return event;
+    }
+    
+    static std::unique_ptr<MetaEvent> parseMetaEvent(const JsonCursor& json) {
+        auto event = std::make_unique<MetaEvent>();
+        
+        json.forEachField([&](std::string_view name, const JsonCursor& v) {
+            Key key = KeyTable::lookup(name);
+            if (readCommonField(*event, key, v)) return;
+            
+            if (key == Key::MetaEventType) {
+                std::string_view met = v.getStringView().value_or("");
+                if (met == "lifecycle") event->meta_event_type = MetaEventType::Lifecycle;
+                else if (met == "heartbeat") event->meta_event_type = MetaEventType::Heartbeat;
+            }
+            else if (key == Key::SubType) assignString(event->sub_type, v);
+            else if (key == Key::Interval) event->interval = v.getInt64(0);
+        });
+        
+        return event;
+    }
+    
     static std::unique_ptr<MessageEvent> parseMessageEvent(const JsonValue& json) {
         auto event = std::make_unique<MessageEvent>();
         const auto& obj = json.asObject();
@@ -181,11 +501,11 @@ private:
                             if (data.isObject()) {
                                 for (const auto& [k, v] : data.asObject()) {
                                     if (v.isString()) {
-                                        segment.data[k] = v.asString();
+                                        segment.data.emplace(k, v.asString());
                                     } else if (v.isInt()) {
-                                        segment.data[k] = std::to_string(v.asInt());
+                                        segment.data.emplace(k, std::to_string(v.asInt()));
                                     } else if (v.isBool()) {
-                                        segment.data[k] = v.asBool() ? "true" : "false";
+                                        segment.data.emplace(k, v.asBool() ? "true" : "false");
                                     }
                                 }
                             }
@@ -197,7 +517,7 @@ private:
             } else if (msg.isString()) {
                 MessageSegment seg;
                 seg.type = "text";
-                seg.data["text"] = msg.asString();
+                seg.data[Key::Text] = msg.asString();
                 event->message.push_back(std::move(seg));
             }
         }
@@ -279,7 +599,7 @@ private:
         }
         
         if (obj.find("sub_type") != obj.end()) event->sub_type = obj.at("sub_type").asString();
-        if (obj.find("status") != obj.end()) event->status = obj.at("status");
+        if (obj.find("status") != obj.end()) event->status_data = obj.at("status");
         if (obj.find("interval") != obj.end()) event->interval = obj.at("interval").asInt();
         
         return event;
@@ -7,7 +7,10 @@
 #include <atomic>
 #include <functional>
 #include <filesystem>
+#include <chrono>
+#include <string_view>
 #include "../core/JsonParser.h"
+#include "../core/MessagePack.h"
 #include "../core/Logger.h"
 
 namespace lchbot {
@@ -47,7 +50,11 @@ public:
     }
     
 private:
-    FileMessageQueue() : running_(false), queue_file_("data/py_msg_queue.jsonl") {
+    static constexpr std::chrono::milliseconds kDrainSettle{250};
+    static constexpr std::chrono::milliseconds kTruncatedGrace{5000};
+    
+    FileMessageQueue() : running_(false), queue_file_("data/py_msg_queue.jsonl"), binary_queue_file_("data/py_msg_queue.msgpack"),
+                         draining_file_(binary_queue_file_ + ".draining"), corrupt_file_(binary_queue_file_ + ".corrupt") {
         std::filesystem::create_directories("data");
     }
     
@@ -59,6 +66,7 @@ private:
         while (running_) {
             try {
                 processQueue();
+                processBinaryQueue();
             } catch (const std::exception& e) {
                 LOG_ERROR("[FileMessageQueue] Error: " + std::string(e.what()));
             }
@@ -97,27 +105,7 @@ private:
                     continue;
                 }
                 
-                auto& obj = msg.asObject();
-                std::string action = obj.count("action") ? obj.at("action").asString() : "";
-                int64_t target_id = obj.count("target_id") ? obj.at("target_id").asInt() : 0;
-                std::string message = obj.count("message") ? obj.at("message").asString() : "";
-                
-                if (action.empty() || target_id == 0 || message.empty()) {
-                    continue;
-                }
-                
-                bool success = false;
-                if (action == "send_group_msg" && send_group_callback_) {
-                    send_group_callback_(message, target_id);
-                    success = true;
-                    LOG_INFO("[FileMessageQueue] Sent group msg to " + std::to_string(target_id) + ", len=" + std::to_string(message.length()));
-                } else if (action == "send_private_msg" && send_private_callback_) {
-                    send_private_callback_(message, target_id);
-                    success = true;
-                    LOG_INFO("[FileMessageQueue] Sent private msg to " + std::to_string(target_id) + ", len=" + std::to_string(message.length()));
-                }
-                
-                if (!success) {
+                if (!dispatchRecord(msg)) {
                     failed_lines.push_back(json_line);
                 }
                 
@@ -135,10 +123,103 @@ private:
         }
     }
     
+    void processBinaryQueue() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        auto now = std::chrono::steady_clock::now();
+        if (!std::filesystem::exists(draining_file_)) {
+            if (!std::filesystem::exists(binary_queue_file_)) return;
+            std::error_code ec;
+            std::filesystem::rename(binary_queue_file_, draining_file_, ec);
+            if (ec) return;
+            draining_offset_ = 0;
+            draining_pending_ = 0;
+            draining_changed_ = now;
+        }
+        
+        std::ifstream file(draining_file_, std::ios::binary);
+        if (!file) return;
+        file.seekg(static_cast<std::streamoff>(draining_offset_));
+        std::string content((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+        file.close();
+        
+        LCHBOT::MsgPackReader reader(content);
+        LCHBOT::MsgPackWriter failed;
+        bool corrupt = false;
+        try {
+            while (auto msg = reader.next()) {
+                if (!msg->isObject()) continue;
+                if (!dispatchRecord(*msg)) {
+                    failed.value(*msg);
+                }
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR("[FileMessageQueue] Decode error: " + std::string(e.what()));
+            corrupt = true;
+        }
+        
+        if (!failed.str().empty()) {
+            std::ofstream retry_file(binary_queue_file_, std::ios::app | std::ios::binary);
+            retry_file.write(failed.str().data(), static_cast<std::streamsize>(failed.str().size()));
+        }
+        
+        size_t pending = reader.pending();
+        draining_offset_ += content.size() - pending;
+        if (content.size() != pending || pending != draining_pending_) {
+            draining_pending_ = pending;
+            draining_changed_ = now;
+        }
+        
+        if (corrupt || (pending > 0 && now - draining_changed_ >= kTruncatedGrace)) {
+            quarantine(std::string_view(content).substr(content.size() - pending));
+        } else if (pending > 0 || now - draining_changed_ < kDrainSettle) {
+            return;
+        }
+        
+        std::error_code ec;
+        std::filesystem::remove(draining_file_, ec);
+    }
+    
+    void quarantine(std::string_view bytes) {
+        LOG_ERROR("[FileMessageQueue] Moved " + std::to_string(bytes.size()) + " undecodable bytes to " + corrupt_file_);
+        std::ofstream corrupt_file(corrupt_file_, std::ios::app | std::ios::binary);
+        corrupt_file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    
+    bool dispatchRecord(const LCHBOT::JsonValue& msg) {
+        auto& obj = msg.asObject();
+        std::string action = obj.count("action") ? obj.at("action").asString() : "";
+        int64_t target_id = obj.count("target_id") ? obj.at("target_id").asInt() : 0;
+        std::string message = obj.count("message") ? obj.at("message").asString() : "";
+        
+        if (action.empty() || target_id == 0 || message.empty()) {
+            return true;
+        }
+        
+        if (action == "send_group_msg" && send_group_callback_) {
+            send_group_callback_(message, target_id);
+            LOG_INFO("[FileMessageQueue] Sent group msg to " + std::to_string(target_id) + ", len=" + std::to_string(message.length()));
+            return true;
+        }
+        if (action == "send_private_msg" && send_private_callback_) {
+            send_private_callback_(message, target_id);
+            LOG_INFO("[FileMessageQueue] Sent private msg to " + std::to_string(target_id) + ", len=" + std::to_string(message.length()));
+            return true;
+        }
+        return false;
+    }
+    
     std::mutex mutex_;
     std::atomic<bool> running_;
     std::thread worker_thread_;
     std::string queue_file_;
+    std::string binary_queue_file_;
+    std::string draining_file_;
+    std::string corrupt_file_;
+    uint64_t draining_offset_ = 0;
+    size_t draining_pending_ = 0;
+    std::chrono::steady_clock::time_point draining_changed_;
     SendCallback send_group_callback_;
     SendCallback send_private_callback_;
 };
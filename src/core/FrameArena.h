@@ -0,0 +1,236 @@
+#pragma once
+
+#include <memory_resource>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+
+namespace LCHBOT {
+
+class AllocationStats {
+public:
+    struct Snapshot {
+        uint64_t frames = 0;
+        uint64_t arena_allocations = 0;
+        uint64_t arena_bytes = 0;
+        uint64_t arena_blocks = 0;
+        uint64_t frame_heap_allocations = 0;
+        uint64_t heap_allocations = 0;
+        uint64_t heap_bytes = 0;
+    };
+
+    static AllocationStats& instance() {
+        static AllocationStats inst;
+        return inst;
+    }
+
+    static uint64_t& threadHeapAllocations() {
+        thread_local uint64_t count = 0;
+        return count;
+    }
+
+    void countHeapAllocation(size_t bytes) {
+        heap_allocations_.fetch_add(1, std::memory_order_relaxed);
+        heap_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        ++threadHeapAllocations();
+    }
+
+    void recordFrame(uint64_t arena_allocations, uint64_t arena_bytes, uint64_t arena_blocks) {
+        frames_.fetch_add(1, std::memory_order_relaxed);
+        arena_allocations_.fetch_add(arena_allocations, std::memory_order_relaxed);
+        arena_bytes_.fetch_add(arena_bytes, std::memory_order_relaxed);
+        arena_blocks_.fetch_add(arena_blocks, std::memory_order_relaxed);
+    }
+
+    void recordFrameHeapAllocations(uint64_t count) {
+        frame_heap_allocations_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.frames = frames_.load(std::memory_order_relaxed);
+        s.arena_allocations = arena_allocations_.load(std::memory_order_relaxed);
+        s.arena_bytes = arena_bytes_.load(std::memory_order_relaxed);
+        s.arena_blocks = arena_blocks_.load(std::memory_order_relaxed);
+        s.frame_heap_allocations = frame_heap_allocations_.load(std::memory_order_relaxed);
+        s.heap_allocations = heap_allocations_.load(std::memory_order_relaxed);
+        s.heap_bytes = heap_bytes_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    std::string exportPrometheus() const {
+        Snapshot s = snapshot();
+        std::ostringstream ss;
+        ss << "# HELP lchbot_frames_total Inbound frames parsed into a frame arena\n";
+        ss << "# TYPE lchbot_frames_total counter\n";
+        ss << "lchbot_frames_total " << s.frames << "\n\n";
+        ss << "# HELP lchbot_arena_allocations_total Allocations served by frame arenas\n";
+        ss << "# TYPE lchbot_arena_allocations_total counter\n";
+        ss << "lchbot_arena_allocations_total " << s.arena_allocations << "\n\n";
+        ss << "# HELP lchbot_arena_bytes_total Bytes served by frame arenas\n";
+        ss << "# TYPE lchbot_arena_bytes_total counter\n";
+        ss << "lchbot_arena_bytes_total " << s.arena_bytes << "\n\n";
+        ss << "# HELP lchbot_arena_blocks_total Upstream blocks requested by frame arenas\n";
+        ss << "# TYPE lchbot_arena_blocks_total counter\n";
+        ss << "lchbot_arena_blocks_total " << s.arena_blocks << "\n\n";
+        ss << "# HELP lchbot_frame_heap_allocations_total Global heap allocations made while handling frames (LCHBOT_COUNT_ALLOCATIONS builds only)\n";
+        ss << "# TYPE lchbot_frame_heap_allocations_total counter\n";
+        ss << "lchbot_frame_heap_allocations_total " << s.frame_heap_allocations << "\n\n";
+        ss << "# HELP lchbot_heap_allocations_total Global heap allocations (LCHBOT_COUNT_ALLOCATIONS builds only)\n";
+        ss << "# TYPE lchbot_heap_allocations_total counter\n";
+        ss << "lchbot_heap_allocations_total " << s.heap_allocations << "\n\n";
+        ss << "# HELP lchbot_heap_bytes_total Bytes requested from the global heap (LCHBOT_COUNT_ALLOCATIONS builds only)\n";
+        ss << "# TYPE lchbot_heap_bytes_total counter\n";
+        ss << "lchbot_heap_bytes_total " << s.heap_bytes << "\n\n";
+        return ss.str();
+    }
+
+private:
+    AllocationStats() = default;
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> arena_allocations_{0};
+    std::atomic<uint64_t> arena_bytes_{0};
+    std::atomic<uint64_t> arena_blocks_{0};
+    std::atomic<uint64_t> frame_heap_allocations_{0};
+    std::atomic<uint64_t> heap_allocations_{0};
+    std::atomic<uint64_t> heap_bytes_{0};
+};
+
+class CountingHeap {
+public:
+    static constexpr size_t kDefaultAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    static void* allocate(size_t size, size_t alignment) noexcept {
+        AllocationStats::instance().countHeapAllocation(size);
+        if (size == 0) size = 1;
+        if (alignment <= kDefaultAlignment) return std::malloc(size);
+#ifdef _MSC_VER
+        return _aligned_malloc(size, alignment);
+#else
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    static void* allocateOrThrow(size_t size, size_t alignment) {
+        if (void* p = allocate(size, alignment)) return p;
+        throw std::bad_alloc();
+    }
+
+    static void release(void* p, size_t alignment) noexcept {
+#ifdef _MSC_VER
+        if (alignment > kDefaultAlignment) {
+            _aligned_free(p);
+            return;
+        }
+#else
+        (void)alignment;
+#endif
+        std::free(p);
+    }
+};
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+    uint64_t allocations() const { return allocations_.load(std::memory_order_relaxed); }
+    uint64_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        upstream_->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    std::atomic<uint64_t> allocations_{0};
+    std::atomic<uint64_t> bytes_{0};
+};
+
+class FrameArena {
+public:
+    static constexpr size_t kInitialSize = 16 * 1024;
+    static constexpr size_t kMinInitialSize = 1024;
+
+    explicit FrameArena(size_t initial_size = kInitialSize)
+        : blocks_(std::pmr::new_delete_resource()),
+          monotonic_(initial_size, &blocks_),
+          counting_(&monotonic_) {}
+
+    static size_t initialSizeFor(size_t payload_size) {
+        return std::clamp(payload_size * 32, kMinInitialSize, kInitialSize);
+    }
+
+    ~FrameArena() {
+        AllocationStats::instance().recordFrame(counting_.allocations(), counting_.bytes(), blocks_.allocations());
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &counting_; }
+
+    uint64_t allocations() const { return counting_.allocations(); }
+    uint64_t bytes() const { return counting_.bytes(); }
+    uint64_t upstreamBlocks() const { return blocks_.allocations(); }
+
+private:
+    CountingResource blocks_;
+    std::pmr::monotonic_buffer_resource monotonic_;
+    CountingResource counting_;
+};
+
+class FrameAllocationScope {
+public:
+    FrameAllocationScope() : start_(AllocationStats::threadHeapAllocations()) {}
+
+    ~FrameAllocationScope() {
+        AllocationStats::instance().recordFrameHeapAllocations(AllocationStats::threadHeapAllocations() - start_);
+    }
+
+    FrameAllocationScope(const FrameAllocationScope&) = delete;
+    FrameAllocationScope& operator=(const FrameAllocationScope&) = delete;
+
+private:
+    uint64_t start_;
+};
+
+}
+
+#define LCHBOT_DEFINE_ALLOCATION_HOOKS() \
+    void* operator new(std::size_t size) { return LCHBOT::CountingHeap::allocateOrThrow(size, LCHBOT::CountingHeap::kDefaultAlignment); } \
+    void* operator new[](std::size_t size) { return LCHBOT::CountingHeap::allocateOrThrow(size, LCHBOT::CountingHeap::kDefaultAlignment); } \
+    void* operator new(std::size_t size, std::align_val_t al) { return LCHBOT::CountingHeap::allocateOrThrow(size, static_cast<std::size_t>(al)); } \
+    void* operator new[](std::size_t size, std::align_val_t al) { return LCHBOT::CountingHeap::allocateOrThrow(size, static_cast<std::size_t>(al)); } \
+    void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return LCHBOT::CountingHeap::allocate(size, LCHBOT::CountingHeap::kDefaultAlignment); } \
+    void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return LCHBOT::CountingHeap::allocate(size, LCHBOT::CountingHeap::kDefaultAlignment); } \
+    void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return LCHBOT::CountingHeap::allocate(size, static_cast<std::size_t>(al)); } \
+    void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return LCHBOT::CountingHeap::allocate(size, static_cast<std::size_t>(al)); } \
+    void operator delete(void* p) noexcept { LCHBOT::CountingHeap::release(p, LCHBOT::CountingHeap::kDefaultAlignment); } \
+    void operator delete[](void* p) noexcept { LCHBOT::CountingHeap::release(p, LCHBOT::CountingHeap::kDefaultAlignment); } \
+    void operator delete(void* p, std::size_t) noexcept { LCHBOT::CountingHeap::release(p, LCHBOT::CountingHeap::kDefaultAlignment); } \
+    void operator delete[](void* p, std::size_t) noexcept { LCHBOT::CountingHeap::release(p, LCHBOT::CountingHeap::kDefaultAlignment); } \
+    void operator delete(void* p, std::align_val_t al) noexcept { LCHBOT::CountingHeap::release(p, static_cast<std::size_t>(al)); } \
+    void operator delete[](void* p, std::align_val_t al) noexcept { LCHBOT::CountingHeap::release(p, static_cast<std::size_t>(al)); } \
+    void operator delete(void* p, std::size_t, std::align_val_t al) noexcept { LCHBOT::CountingHeap::release(p, static_cast<std::size_t>(al)); } \
+    void operator delete[](void* p, std::size_t, std::align_val_t al) noexcept { LCHBOT::CountingHeap::release(p, static_cast<std::size_t>(al)); } \
+    void operator delete(void* p, const std::nothrow_t&) noexcept { LCHBOT::CountingHeap::release(p, LCHBOT::CountingHeap::kDefaultAlignment); } \
+    void operator delete[](void* p, const std::nothrow_t&) noexcept { LCHBOT::CountingHeap::release(p, LCHBOT::CountingHeap::kDefaultAlignment); } \
+    void operator delete(void* p, std::align_val_t al, const std::nothrow_t&) noexcept { LCHBOT::CountingHeap::release(p, static_cast<std::size_t>(al)); } \
+    void operator delete[](void* p, std::align_val_t al, const std::nothrow_t&) noexcept { LCHBOT::CountingHeap::release(p, static_cast<std::size_t>(al)); }
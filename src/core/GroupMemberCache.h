@@ -5,6 +5,9 @@
 #include <set>
 #include <vector>
 #include <mutex>
+#include <charconv>
+#include "JsonWriter.h"
+#include "TextEscape.h"
 
 namespace LCHBOT {
 
@@ -17,6 +20,7 @@ struct GroupMemberCache {
     void setMembers(int64_t group_id, const std::vector<std::pair<int64_t, std::string>>& members) {
         std::lock_guard<std::mutex> lock(mutex_);
         cache_[group_id] = members;
+        dirty_ = true;
     }
     
     bool hasGroup(int64_t group_id) {
@@ -36,42 +40,43 @@ struct GroupMemberCache {
     
     std::string toJson() {
         std::lock_guard<std::mutex> lock(mutex_);
-        std::string result = "{";
-        bool first_group = true;
+        refreshSerialized();
+        return json_;
+    }
+    
+    std::string toPythonLiteral() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refreshSerialized();
+        return python_literal_;
+    }
+    
+private:
+    void refreshSerialized() {
+        if (!dirty_) return;
+        json_.clear();
+        JsonWriter writer(json_);
+        writer.beginObject();
+        char buf[24];
         for (const auto& [gid, members] : cache_) {
-            if (!first_group) result += ",";
-            first_group = false;
-            result += "\"" + std::to_string(gid) + "\":{";
-            bool first_member = true;
+            auto gid_end = std::to_chars(buf, buf + sizeof(buf), gid).ptr;
+            writer.key(std::string_view(buf, gid_end - buf)).beginObject();
             for (const auto& [uid, nick] : members) {
-                if (!first_member) result += ",";
-                first_member = false;
-                std::string escaped_nick;
-                for (unsigned char c : nick) {
-                    if (c == '"') escaped_nick += "\\\"";
-                    else if (c == '\\') escaped_nick += "\\\\";
-                    else if (c == '\n') escaped_nick += "\\n";
-                    else if (c == '\r') escaped_nick += "\\r";
-                    else if (c == '\t') escaped_nick += "\\t";
-                    else if (c < 0x20) {
-                        char buf[8];
-                        snprintf(buf, sizeof(buf), "\\u%04x", c);
-                        escaped_nick += buf;
-                    }
-                    else escaped_nick += c;
-                }
-                result += "\"" + std::to_string(uid) + "\":\"" + escaped_nick + "\"";
+                auto uid_end = std::to_chars(buf, buf + sizeof(buf), uid).ptr;
+                writer.key(std::string_view(buf, uid_end - buf)).value(nick);
             }
-            result += "}";
+            writer.endObject();
         }
-        result += "}";
-        return result;
+        writer.endObject();
+        python_literal_ = TextEscape::pythonLiteral(json_, '\'');
+        dirty_ = false;
     }
     
-private:
     std::map<int64_t, std::vector<std::pair<int64_t, std::string>>> cache_;
     std::set<int64_t> pending_;
     std::mutex mutex_;
+    std::string json_;
+    std::string python_literal_;
+    bool dirty_ = true;
 };
 
 }
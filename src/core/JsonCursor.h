@@ -0,0 +1,310 @@
+#pragma once
+
+#include "Types.h"
+#include "JsonDocument.h"
+#include <string>
+#include <string_view>
+#include <optional>
+#include <charconv>
+#include <stdexcept>
+#include <type_traits>
+
+namespace LCHBOT {
+
+class JsonCursor {
+public:
+    JsonCursor() = default;
+
+    explicit JsonCursor(std::string_view json) : json_(json) {
+        pos_ = skipWhitespace(0);
+        valid_ = pos_ < json_.size();
+    }
+
+    bool valid() const { return valid_; }
+    explicit operator bool() const { return valid_; }
+
+    JsonKind kind() const {
+        if (!valid_) return JsonKind::Null;
+        switch (json_[pos_]) {
+            case '{': return JsonKind::Object;
+            case '[': return JsonKind::Array;
+            case '"': return JsonKind::String;
+            case 't': case 'f': return JsonKind::Bool;
+            case 'n': return JsonKind::Null;
+            default: break;
+        }
+        for (size_t i = pos_; i < json_.size() && !isDelimiter(json_[i]); ++i) {
+            if (json_[i] == '.' || json_[i] == 'e' || json_[i] == 'E') {
+                return getDouble() ? JsonKind::Double : JsonKind::BigNumber;
+            }
+        }
+        return getInt64() ? JsonKind::Int : JsonKind::BigNumber;
+    }
+
+    bool isObject() const { return valid_ && json_[pos_] == '{'; }
+    bool isArray() const { return valid_ && json_[pos_] == '['; }
+    bool isString() const { return valid_ && json_[pos_] == '"'; }
+    bool isNull() const { return !valid_ || json_[pos_] == 'n'; }
+    bool isBool() const { return valid_ && (json_[pos_] == 't' || json_[pos_] == 'f'); }
+    bool isNumber() const { return valid_ && (json_[pos_] == '-' || (json_[pos_] >= '0' && json_[pos_] <= '9')); }
+    bool isBigNumber() const { return isNumber() && kind() == JsonKind::BigNumber; }
+
+    std::string_view raw() const {
+        if (!valid_) return {};
+        return json_.substr(pos_, valueEnd(*this) - pos_);
+    }
+
+    std::optional<int64_t> getInt64() const {
+        if (!isNumber()) return std::nullopt;
+        const char* first = json_.data() + pos_;
+        const char* last = json_.data() + json_.size();
+        int64_t value = 0;
+        auto [ptr, ec] = std::from_chars(first, last, value);
+        if (ec != std::errc()) return std::nullopt;
+        if (ptr != last && (*ptr == '.' || *ptr == 'e' || *ptr == 'E')) {
+            double d = 0.0;
+            std::from_chars(first, last, d);
+            return static_cast<int64_t>(d);
+        }
+        return value;
+    }
+
+    std::optional<double> getDouble() const {
+        if (!isNumber()) return std::nullopt;
+        double value = 0.0;
+        auto [ptr, ec] = std::from_chars(json_.data() + pos_, json_.data() + json_.size(), value);
+        if (ec != std::errc()) return std::nullopt;
+        return value;
+    }
+
+    std::optional<bool> getBool() const {
+        if (!isBool()) return std::nullopt;
+        return json_[pos_] == 't';
+    }
+
+    std::optional<std::string_view> getStringView() const {
+        if (!isString()) return std::nullopt;
+        size_t end = end_ = skipString(pos_);
+        std::string_view body = json_.substr(pos_ + 1, end - pos_ - 2);
+        if (body.find('\\') != std::string_view::npos) return std::nullopt;
+        return body;
+    }
+
+    std::string getString() const {
+        if (!isString()) return std::string();
+        size_t end = end_ = skipString(pos_);
+        std::string_view body = json_.substr(pos_ + 1, end - pos_ - 2);
+        if (body.find('\\') == std::string_view::npos) return std::string(body);
+        std::string result;
+        JsonDocument::appendUnescaped(body, result);
+        return result;
+    }
+
+    int64_t getInt64(int64_t def) const { return getInt64().value_or(def); }
+
+    JsonCursor findField(std::string_view key) const {
+        JsonCursor found;
+        forEachField([&](std::string_view k, const JsonCursor& v) {
+            if (k == key) {
+                found = v;
+                return false;
+            }
+            return true;
+        });
+        return found;
+    }
+
+    JsonCursor findField(Key key) const { return findField(KeyTable::name(key)); }
+
+    template <typename F>
+    void forEachField(F&& f) const {
+        if (!isObject()) return;
+        size_t pos = skipWhitespace(pos_ + 1);
+        if (pos < json_.size() && json_[pos] == '}') {
+            end_ = pos + 1;
+            return;
+        }
+
+        std::string decoded;
+        while (true) {
+            if (pos >= json_.size() || json_[pos] != '"') {
+                throw std::runtime_error("Expected string key in object");
+            }
+            size_t key_end = skipString(pos);
+            std::string_view key = json_.substr(pos + 1, key_end - pos - 2);
+            if (key.find('\\') != std::string_view::npos) {
+                decoded.clear();
+                JsonDocument::appendUnescaped(key, decoded);
+                key = decoded;
+            }
+
+            pos = skipWhitespace(key_end);
+            if (pos >= json_.size() || json_[pos] != ':') {
+                throw std::runtime_error("Expected ':' in object");
+            }
+            pos = skipWhitespace(pos + 1);
+
+            JsonCursor value(json_, pos);
+            if (!invoke(f, key, value)) return;
+
+            pos = skipWhitespace(valueEnd(value));
+            if (pos >= json_.size()) {
+                throw std::runtime_error("Unterminated object");
+            }
+            if (json_[pos] == '}') {
+                end_ = pos + 1;
+                return;
+            }
+            if (json_[pos] != ',') {
+                throw std::runtime_error("Expected ',' in object");
+            }
+            pos = skipWhitespace(pos + 1);
+        }
+    }
+
+    template <typename F>
+    void forEachElement(F&& f) const {
+        if (!isArray()) return;
+        size_t pos = skipWhitespace(pos_ + 1);
+        if (pos < json_.size() && json_[pos] == ']') {
+            end_ = pos + 1;
+            return;
+        }
+
+        while (true) {
+            if (pos >= json_.size()) {
+                throw std::runtime_error("Unterminated array");
+            }
+            JsonCursor value(json_, pos);
+            if (!invoke(f, value)) return;
+
+            pos = skipWhitespace(valueEnd(value));
+            if (pos >= json_.size()) {
+                throw std::runtime_error("Unterminated array");
+            }
+            if (json_[pos] == ']') {
+                end_ = pos + 1;
+                return;
+            }
+            if (json_[pos] != ',') {
+                throw std::runtime_error("Expected ',' in array");
+            }
+            pos = skipWhitespace(pos + 1);
+        }
+    }
+
+    size_t count() const {
+        size_t n = 0;
+        if (isArray()) {
+            forEachElement([&](const JsonCursor&) { ++n; });
+        } else if (isObject()) {
+            forEachField([&](std::string_view, const JsonCursor&) { ++n; });
+        }
+        return n;
+    }
+
+private:
+    JsonCursor(std::string_view json, size_t pos) : json_(json), pos_(pos), valid_(pos < json.size()) {}
+
+    template <typename F, typename... Args>
+    static bool invoke(F& f, Args&&... args) {
+        if constexpr (std::is_same_v<decltype(f(std::forward<Args>(args)...)), void>) {
+            f(std::forward<Args>(args)...);
+            return true;
+        } else {
+            return static_cast<bool>(f(std::forward<Args>(args)...));
+        }
+    }
+
+    static bool isDelimiter(char c) {
+        switch (c) {
+            case ' ': case '\n': case '\r': case '\t':
+            case ',': case ':': case '}': case ']': case '{': case '[': case '"':
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    size_t skipWhitespace(size_t pos) const {
+        while (pos < json_.size()) {
+            char c = json_[pos];
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+            ++pos;
+        }
+        return pos;
+    }
+
+    size_t skipString(size_t pos) const {
+        size_t i = pos + 1;
+        while (true) {
+            i = json_.find_first_of("\"\\", i);
+            if (i == std::string_view::npos) {
+                throw std::runtime_error("Unterminated string");
+            }
+            if (json_[i] == '"') return i + 1;
+            i += 2;
+        }
+    }
+
+    size_t skipValue(size_t pos) const {
+        if (pos >= json_.size()) {
+            throw std::runtime_error("Unexpected end of JSON");
+        }
+
+        char c = json_[pos];
+        if (c == '"') return skipString(pos);
+
+        if (c == '{' || c == '[') {
+            uint64_t shallow = 0;
+            std::string deep;
+            size_t depth = 0;
+            size_t i = pos;
+            while (i < json_.size()) {
+                i = json_.find_first_of("\"{}[]", i);
+                if (i == std::string_view::npos) break;
+                char d = json_[i];
+                if (d == '"') {
+                    i = skipString(i);
+                    continue;
+                }
+                if (d == '{' || d == '[') {
+                    if (depth < 64) {
+                        shallow = (d == '{') ? (shallow | (uint64_t(1) << depth)) : (shallow & ~(uint64_t(1) << depth));
+                    } else {
+                        deep.push_back(d);
+                    }
+                    ++depth;
+                } else {
+                    --depth;
+                    bool object = depth < 64 ? ((shallow >> depth) & 1) != 0 : deep.back() == '{';
+                    if (depth >= 64) deep.pop_back();
+                    if (object != (d == '}')) {
+                        throw std::runtime_error("Mismatched bracket in JSON");
+                    }
+                    if (depth == 0) return i + 1;
+                }
+                ++i;
+            }
+            throw std::runtime_error(c == '{' ? "Unterminated object" : "Unterminated array");
+        }
+
+        size_t i = pos;
+        while (i < json_.size() && !isDelimiter(json_[i])) ++i;
+        if (i == pos) {
+            throw std::runtime_error("Invalid JSON value");
+        }
+        return i;
+    }
+
+    size_t valueEnd(const JsonCursor& value) const {
+        return value.end_ != std::string_view::npos ? value.end_ : skipValue(value.pos_);
+    }
+
+    std::string_view json_;
+    size_t pos_ = 0;
+    mutable size_t end_ = std::string_view::npos;
+    bool valid_ = false;
+};
+
+}
@@ -0,0 +1,640 @@
+#pragma once
+
+#include "Types.h"
+#include "JsonStructuralIndex.h"
+#include "FrameArena.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory_resource>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <charconv>
+
+namespace LCHBOT {
+
+class JsonDocument;
+
+enum class JsonKind : uint8_t {
+    Null,
+    Bool,
+    Int,
+    Double,
+    String,
+    Array,
+    Object,
+    BigNumber
+};
+
+class JsonView {
+public:
+    JsonView() = default;
+    JsonView(const JsonDocument* doc, uint32_t index) : doc_(doc), index_(index) {}
+
+    bool valid() const { return doc_ != nullptr; }
+    const JsonDocument* document() const { return doc_; }
+    explicit operator bool() const { return valid(); }
+
+    JsonKind kind() const;
+    bool isNull() const { return !valid() || kind() == JsonKind::Null; }
+    bool isBool() const { return valid() && kind() == JsonKind::Bool; }
+    bool isInt() const { return valid() && kind() == JsonKind::Int; }
+    bool isDouble() const { return valid() && kind() == JsonKind::Double; }
+    bool isString() const { return valid() && kind() == JsonKind::String; }
+    bool isArray() const { return valid() && kind() == JsonKind::Array; }
+    bool isObject() const { return valid() && kind() == JsonKind::Object; }
+    bool isBigNumber() const { return valid() && kind() == JsonKind::BigNumber; }
+    bool isNumber() const { return isInt() || isDouble() || isBigNumber(); }
+
+    bool asBool() const;
+    int64_t asInt() const;
+    double asDouble() const;
+    std::string_view asStringView() const;
+    std::string asString() const { return std::string(asStringView()); }
+
+    size_t size() const;
+    JsonView find(std::string_view key) const;
+    JsonView find(Key key) const;
+    JsonView operator[](std::string_view key) const { return find(key); }
+    JsonView operator[](Key key) const { return find(key); }
+    JsonView at(size_t index) const;
+    bool contains(std::string_view key) const { return find(key).valid(); }
+
+    std::string_view getString(std::string_view key, std::string_view def = {}) const {
+        JsonView v = find(key);
+        return v.isString() ? v.asStringView() : def;
+    }
+
+    int64_t getInt(std::string_view key, int64_t def = 0) const {
+        JsonView v = find(key);
+        return v.isInt() ? v.asInt() : def;
+    }
+
+    JsonValue toValue() const;
+
+    class ElementIterator {
+    public:
+        ElementIterator(const JsonDocument* doc, uint32_t index) : doc_(doc), index_(index) {}
+        JsonView operator*() const { return JsonView(doc_, index_); }
+        ElementIterator& operator++();
+        bool operator!=(const ElementIterator& other) const { return index_ != other.index_; }
+        bool operator==(const ElementIterator& other) const { return index_ == other.index_; }
+    private:
+        const JsonDocument* doc_;
+        uint32_t index_;
+    };
+
+    class MemberIterator {
+    public:
+        MemberIterator(const JsonDocument* doc, uint32_t index) : doc_(doc), index_(index) {}
+        std::pair<std::string_view, JsonView> operator*() const;
+        MemberIterator& operator++();
+        bool operator!=(const MemberIterator& other) const { return index_ != other.index_; }
+        bool operator==(const MemberIterator& other) const { return index_ == other.index_; }
+    private:
+        const JsonDocument* doc_;
+        uint32_t index_;
+    };
+
+    template <typename It>
+    struct Range {
+        It first;
+        It last;
+        It begin() const { return first; }
+        It end() const { return last; }
+    };
+
+    Range<ElementIterator> elements() const;
+    Range<MemberIterator> members() const;
+
+private:
+    const JsonDocument* doc_ = nullptr;
+    uint32_t index_ = 0;
+};
+
+class JsonDocument {
+public:
+    struct Node {
+        JsonKind kind = JsonKind::Null;
+        bool flag = false;
+        uint32_t count = 0;
+        uint32_t next = 0;
+        Key atom = Key::None;
+        int64_t i = 0;
+        double d = 0.0;
+        std::string_view str;
+    };
+
+    static std::shared_ptr<JsonDocument> parse(std::string buffer) {
+        auto doc = adopt(std::move(buffer));
+        doc->ensureBuilt();
+        return doc;
+    }
+
+    static std::shared_ptr<JsonDocument> adopt(std::string buffer) {
+        return std::shared_ptr<JsonDocument>(new JsonDocument(std::move(buffer)));
+    }
+
+    JsonView root() const {
+        ensureBuilt();
+        return nodes_.empty() ? JsonView() : JsonView(this, 0);
+    }
+
+    bool isBuilt() const { return built_; }
+
+    const std::string& buffer() const { return buffer_; }
+    std::pmr::memory_resource* resource() const { return arena_.resource(); }
+    const FrameArena& arena() const { return arena_; }
+    size_t nodeCount() const { return nodes_.size(); }
+    size_t materializedCount() const { return materialized_.size(); }
+
+    const Node& node(uint32_t index) const { return nodes_[index]; }
+
+    template <typename String>
+    static void appendUnescaped(std::string_view body, String& result) {
+        result.reserve(result.size() + body.size());
+        size_t pos = 0;
+        size_t end = body.size();
+
+        while (pos < end) {
+            size_t stop = body.find('\\', pos);
+            if (stop == std::string_view::npos) stop = end;
+            result.append(body.data() + pos, stop - pos);
+            pos = stop;
+            if (pos >= end) break;
+
+            ++pos;
+            if (pos >= end) {
+                throw std::runtime_error("Unterminated string");
+            }
+
+            switch (body[pos]) {
+                case '"': result += '"'; break;
+                case '\\': result += '\\'; break;
+                case '/': result += '/'; break;
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'n': result += '\n'; break;
+                case 'r': result += '\r'; break;
+                case 't': result += '\t'; break;
+                case 'u': {
+                    if (pos + 4 >= end) {
+                        throw std::runtime_error("Invalid unicode escape");
+                    }
+                    uint32_t codepoint = parseHex4(body, pos + 1);
+                    pos += 4;
+
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                        if (pos + 6 < end && body[pos + 1] == '\\' && body[pos + 2] == 'u') {
+                            uint32_t low = parseHex4(body, pos + 3);
+                            if (low >= 0xDC00 && low <= 0xDFFF) {
+                                codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                                pos += 6;
+                            }
+                        }
+                    }
+
+                    appendUtf8(result, codepoint);
+                    break;
+                }
+                default:
+                    result += body[pos];
+            }
+            ++pos;
+        }
+    }
+
+    template <typename String>
+    static void appendUtf8(String& out, uint32_t codepoint) {
+        if (codepoint < 0x80) {
+            out += static_cast<char>(codepoint);
+        } else if (codepoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else if (codepoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codepoint >> 18));
+            out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    static uint32_t parseHex4(std::string_view body, size_t pos) {
+        if (pos + 4 > body.size()) {
+            throw std::runtime_error("Invalid unicode escape");
+        }
+        uint32_t value = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            char h = body[pos + i];
+            value <<= 4;
+            if (h >= '0' && h <= '9') value |= static_cast<uint32_t>(h - '0');
+            else if (h >= 'a' && h <= 'f') value |= static_cast<uint32_t>(h - 'a' + 10);
+            else if (h >= 'A' && h <= 'F') value |= static_cast<uint32_t>(h - 'A' + 10);
+            else throw std::runtime_error("Invalid unicode escape");
+        }
+        return value;
+    }
+
+private:
+    friend class JsonPushParser;
+
+    explicit JsonDocument(std::string buffer)
+        : buffer_(std::move(buffer)),
+          arena_(FrameArena::initialSizeFor(buffer_.size())),
+          index_(arena_.resource()),
+          nodes_(arena_.resource()),
+          materialized_(arena_.resource()) {}
+
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+    void ensureBuilt() const {
+        std::call_once(build_once_, [this]() {
+            const_cast<JsonDocument*>(this)->build();
+            built_ = true;
+        });
+    }
+
+    void build() {
+        if (!index_.finished()) {
+            index_.build(buffer_);
+        }
+        nodes_.reserve(index_.size() + 1);
+        size_t k = 0;
+        parseValue(k);
+        if (index_[k] != buffer_.size()) {
+            throw std::runtime_error("Trailing characters after JSON");
+        }
+    }
+
+    static bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static bool isDelimiter(char c) {
+        switch (c) {
+            case ' ': case '\n': case '\r': case '\t':
+            case ',': case ':': case '}': case ']': case '{': case '[': case '"':
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    char charAt(size_t k) const {
+        uint32_t pos = index_[k];
+        return pos < buffer_.size() ? buffer_[pos] : '\0';
+    }
+
+    uint32_t push(JsonKind kind) {
+        Node n;
+        n.kind = kind;
+        nodes_.push_back(n);
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    void parseValue(size_t& k) {
+        if (index_[k] >= buffer_.size()) {
+            throw std::runtime_error("Unexpected end of JSON");
+        }
+
+        char c = charAt(k);
+
+        if (c == '"') {
+            uint32_t idx = push(JsonKind::String);
+            nodes_[idx].str = parseString(k);
+            nodes_[idx].next = idx + 1;
+        } else if (c == '{') {
+            parseObject(k);
+        } else if (c == '[') {
+            parseArray(k);
+        } else if (c == 't' || c == 'f' || c == 'n') {
+            parseLiteral(k);
+        } else if (c == '-' || isDigit(c)) {
+            parseNumber(k);
+        } else {
+            throw std::runtime_error("Invalid JSON value");
+        }
+    }
+
+    void expectScalarEnd(size_t pos) const {
+        if (pos < buffer_.size() && !isDelimiter(buffer_[pos])) {
+            throw std::runtime_error("Invalid JSON value");
+        }
+    }
+
+    void parseLiteral(size_t& k) {
+        size_t pos = index_[k++];
+        std::string_view rest(buffer_.data() + pos, buffer_.size() - pos);
+        uint32_t idx;
+        if (rest.substr(0, 4) == "null") {
+            idx = push(JsonKind::Null);
+            pos += 4;
+        } else if (rest.substr(0, 4) == "true") {
+            idx = push(JsonKind::Bool);
+            nodes_[idx].flag = true;
+            pos += 4;
+        } else if (rest.substr(0, 5) == "false") {
+            idx = push(JsonKind::Bool);
+            pos += 5;
+        } else {
+            throw std::runtime_error("Invalid literal value");
+        }
+        expectScalarEnd(pos);
+        nodes_[idx].next = idx + 1;
+    }
+
+    void parseNumber(size_t& k) {
+        size_t start = index_[k++];
+        size_t pos = start;
+        bool is_float = false;
+
+        if (buffer_[pos] == '-') ++pos;
+        if (pos >= buffer_.size() || !isDigit(buffer_[pos])) {
+            throw std::runtime_error("Invalid number");
+        }
+        while (pos < buffer_.size() && isDigit(buffer_[pos])) ++pos;
+
+        if (pos < buffer_.size() && buffer_[pos] == '.') {
+            is_float = true;
+            ++pos;
+            while (pos < buffer_.size() && isDigit(buffer_[pos])) ++pos;
+        }
+
+        if (pos < buffer_.size() && (buffer_[pos] == 'e' || buffer_[pos] == 'E')) {
+            is_float = true;
+            ++pos;
+            if (pos < buffer_.size() && (buffer_[pos] == '+' || buffer_[pos] == '-')) ++pos;
+            while (pos < buffer_.size() && isDigit(buffer_[pos])) ++pos;
+        }
+
+        expectScalarEnd(pos);
+
+        const char* first = buffer_.data() + start;
+        const char* last = buffer_.data() + pos;
+        uint32_t idx;
+        if (is_float) {
+            double d = 0.0;
+            auto [ptr, ec] = std::from_chars(first, last, d);
+            if (ec == std::errc() && ptr == last) {
+                idx = push(JsonKind::Double);
+                nodes_[idx].d = d;
+            } else {
+                idx = push(JsonKind::BigNumber);
+            }
+        } else {
+            int64_t i = 0;
+            auto [ptr, ec] = std::from_chars(first, last, i);
+            if (ec == std::errc() && ptr == last) {
+                idx = push(JsonKind::Int);
+                nodes_[idx].i = i;
+            } else {
+                idx = push(JsonKind::BigNumber);
+            }
+        }
+        nodes_[idx].str = std::string_view(first, pos - start);
+        nodes_[idx].next = idx + 1;
+    }
+
+    std::string_view parseString(size_t& k) {
+        size_t start = index_[k] + 1;
+        size_t end = index_[k + 1];
+        k += 2;
+
+        if (std::memchr(buffer_.data() + start, '\\', end - start) == nullptr) {
+            return std::string_view(buffer_.data() + start, end - start);
+        }
+        return unescape(start, end);
+    }
+
+    std::string_view unescape(size_t start, size_t end) {
+        std::pmr::string result(arena_.resource());
+        appendUnescaped(std::string_view(buffer_.data() + start, end - start), result);
+        materialized_.push_back(std::move(result));
+        return materialized_.back();
+    }
+
+    void parseArray(size_t& k) {
+        uint32_t idx = push(JsonKind::Array);
+        ++k;
+
+        uint32_t count = 0;
+        if (charAt(k) == ']') {
+            ++k;
+        } else {
+            while (true) {
+                parseValue(k);
+                ++count;
+
+                char c = charAt(k);
+                if (c == ']') {
+                    ++k;
+                    break;
+                }
+                if (c == '\0') {
+                    throw std::runtime_error("Unterminated array");
+                }
+                if (c != ',') {
+                    throw std::runtime_error("Expected ',' in array");
+                }
+                ++k;
+            }
+        }
+
+        nodes_[idx].count = count;
+        nodes_[idx].next = static_cast<uint32_t>(nodes_.size());
+    }
+
+    void parseObject(size_t& k) {
+        uint32_t idx = push(JsonKind::Object);
+        ++k;
+
+        uint32_t count = 0;
+        if (charAt(k) == '}') {
+            ++k;
+        } else {
+            while (true) {
+                if (charAt(k) != '"') {
+                    throw std::runtime_error("Expected string key in object");
+                }
+
+                uint32_t key = push(JsonKind::String);
+                nodes_[key].str = parseString(k);
+                nodes_[key].atom = KeyTable::lookup(nodes_[key].str);
+                nodes_[key].next = key + 1;
+
+                if (charAt(k) != ':') {
+                    throw std::runtime_error("Expected ':' in object");
+                }
+                ++k;
+
+                parseValue(k);
+                ++count;
+
+                char c = charAt(k);
+                if (c == '}') {
+                    ++k;
+                    break;
+                }
+                if (c == '\0') {
+                    throw std::runtime_error("Unterminated object");
+                }
+                if (c != ',') {
+                    throw std::runtime_error("Expected ',' in object");
+                }
+                ++k;
+            }
+        }
+
+        nodes_[idx].count = count;
+        nodes_[idx].next = static_cast<uint32_t>(nodes_.size());
+    }
+
+    std::string buffer_;
+    mutable FrameArena arena_;
+    JsonStructuralIndex index_;
+    std::pmr::vector<Node> nodes_;
+    std::pmr::deque<std::pmr::string> materialized_;
+    mutable std::once_flag build_once_;
+    mutable std::atomic<bool> built_{false};
+};
+
+inline JsonKind JsonView::kind() const {
+    return doc_->node(index_).kind;
+}
+
+inline bool JsonView::asBool() const {
+    const auto& n = doc_->node(index_);
+    if (n.kind != JsonKind::Bool) throw std::runtime_error("JSON value is not a bool");
+    return n.flag;
+}
+
+inline int64_t JsonView::asInt() const {
+    const auto& n = doc_->node(index_);
+    if (n.kind == JsonKind::Int) return n.i;
+    if (n.kind == JsonKind::Double) return static_cast<int64_t>(n.d);
+    if (n.kind == JsonKind::BigNumber) throw std::out_of_range("JSON number does not fit in int64");
+    throw std::runtime_error("JSON value is not a number");
+}
+
+inline double JsonView::asDouble() const {
+    const auto& n = doc_->node(index_);
+    if (n.kind == JsonKind::Double) return n.d;
+    if (n.kind == JsonKind::Int) return static_cast<double>(n.i);
+    if (n.kind == JsonKind::BigNumber) return std::strtod(std::string(n.str).c_str(), nullptr);
+    throw std::runtime_error("JSON value is not a number");
+}
+
+inline std::string_view JsonView::asStringView() const {
+    const auto& n = doc_->node(index_);
+    if (n.kind != JsonKind::String) throw std::runtime_error("JSON value is not a string");
+    return n.str;
+}
+
+inline size_t JsonView::size() const {
+    if (!valid()) return 0;
+    const auto& n = doc_->node(index_);
+    return (n.kind == JsonKind::Array || n.kind == JsonKind::Object) ? n.count : 0;
+}
+
+inline JsonView JsonView::find(std::string_view key) const {
+    if (!isObject()) return JsonView();
+    const auto& obj = doc_->node(index_);
+    uint32_t i = index_ + 1;
+    while (i < obj.next) {
+        const auto& k = doc_->node(i);
+        if (k.str == key) return JsonView(doc_, i + 1);
+        i = doc_->node(i + 1).next;
+    }
+    return JsonView();
+}
+
+inline JsonView JsonView::find(Key key) const {
+    if (!isObject()) return JsonView();
+    const auto& obj = doc_->node(index_);
+    uint32_t i = index_ + 1;
+    while (i < obj.next) {
+        const auto& k = doc_->node(i);
+        if (key != Key::None && k.atom == key) return JsonView(doc_, i + 1);
+        i = doc_->node(i + 1).next;
+    }
+    return JsonView();
+}
+
+inline JsonView JsonView::at(size_t index) const {
+    if (!isArray() || index >= size()) return JsonView();
+    uint32_t i = index_ + 1;
+    while (index-- > 0) {
+        i = doc_->node(i).next;
+    }
+    return JsonView(doc_, i);
+}
+
+inline JsonView::ElementIterator& JsonView::ElementIterator::operator++() {
+    index_ = doc_->node(index_).next;
+    return *this;
+}
+
+inline std::pair<std::string_view, JsonView> JsonView::MemberIterator::operator*() const {
+    return {doc_->node(index_).str, JsonView(doc_, index_ + 1)};
+}
+
+inline JsonView::MemberIterator& JsonView::MemberIterator::operator++() {
+    index_ = doc_->node(index_ + 1).next;
+    return *this;
+}
+
+inline JsonView::Range<JsonView::ElementIterator> JsonView::elements() const {
+    if (!isArray()) return {ElementIterator(doc_, 0), ElementIterator(doc_, 0)};
+    return {ElementIterator(doc_, index_ + 1), ElementIterator(doc_, doc_->node(index_).next)};
+}
+
+inline JsonView::Range<JsonView::MemberIterator> JsonView::members() const {
+    if (!isObject()) return {MemberIterator(doc_, 0), MemberIterator(doc_, 0)};
+    return {MemberIterator(doc_, index_ + 1), MemberIterator(doc_, doc_->node(index_).next)};
+}
+
+inline JsonValue JsonView::toValue() const {
+    if (!valid()) return JsonValue();
+    const auto& n = doc_->node(index_);
+    switch (n.kind) {
+        case JsonKind::Null: return JsonValue(nullptr);
+        case JsonKind::Bool: return JsonValue(n.flag);
+        case JsonKind::Int: return JsonValue(n.i);
+        case JsonKind::Double: return JsonValue(n.d);
+        case JsonKind::String: return JsonValue(std::string(n.str));
+        case JsonKind::BigNumber: return JsonValue(JsonBigNumber{std::string(n.str)});
+        case JsonKind::Array: {
+            std::vector<JsonValue> arr;
+            arr.reserve(n.count);
+            for (JsonView e : elements()) {
+                arr.push_back(e.toValue());
+            }
+            return JsonValue(std::move(arr));
+        }
+        case JsonKind::Object: {
+            JsonObject obj;
+            obj.reserve(n.count);
+            uint32_t i = index_ + 1;
+            while (i < n.next) {
+                const auto& k = doc_->node(i);
+                JsonKey key = k.atom != Key::None ? JsonKey(k.atom) : JsonKey(k.str);
+                obj.insert_or_assign(std::move(key), JsonView(doc_, i + 1).toValue());
+                i = doc_->node(i + 1).next;
+            }
+            return JsonValue(std::move(obj));
+        }
+    }
+    return JsonValue();
+}
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "JsonDocument.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+
+namespace LCHBOT {
+
+class JsonPushParser {
+public:
+    enum class Status {
+        NeedMore,
+        Complete
+    };
+
+    void begin(size_t expected_size = 0) {
+        doc_.reset(new JsonDocument(std::string()));
+        doc_->buffer_.reserve(expected_size);
+        doc_->index_.reserve(expected_size);
+        consumed_ = 0;
+        depth_ = 0;
+        complete_ = false;
+    }
+
+    bool active() const { return doc_ != nullptr; }
+    bool complete() const { return complete_; }
+    size_t size() const { return doc_ ? doc_->buffer_.size() : 0; }
+
+    Status feed(std::string_view chunk) {
+        if (!doc_) begin(chunk.size());
+
+        std::string& buffer = doc_->buffer_;
+        buffer.append(chunk.data(), chunk.size());
+
+        if (!complete_) {
+            doc_->index_.advance(buffer);
+            consumePositions();
+            if (!complete_) {
+                complete_ = tailCloses();
+            }
+        }
+
+        return complete_ ? Status::Complete : Status::NeedMore;
+    }
+
+    std::shared_ptr<JsonDocument> finish() {
+        if (!doc_) {
+            throw std::runtime_error("Unexpected end of JSON");
+        }
+        std::shared_ptr<JsonDocument> doc = std::move(doc_);
+        doc->index_.finish(doc->buffer_);
+        return doc;
+    }
+
+    void reset() { doc_.reset(); }
+
+private:
+    void consumePositions() {
+        const auto& positions = doc_->index_.positions();
+        const std::string& buffer = doc_->buffer_;
+        for (; consumed_ < positions.size(); ++consumed_) {
+            char c = buffer[positions[consumed_]];
+            if (c == '{' || c == '[') {
+                ++depth_;
+            } else if (c == '}' || c == ']') {
+                if (depth_ == 0) {
+                    throw std::runtime_error("Unexpected closing bracket");
+                }
+                if (--depth_ == 0) {
+                    complete_ = true;
+                }
+            }
+        }
+    }
+
+    bool tailCloses() const {
+        const std::string& buffer = doc_->buffer_;
+        bool in_string = doc_->index_.inString();
+        bool escaped = doc_->index_.pendingEscape();
+        size_t depth = depth_;
+        for (size_t i = doc_->index_.processed(); i < buffer.size(); ++i) {
+            char c = buffer[i];
+            if (escaped) {
+                escaped = false;
+            } else if (in_string) {
+                if (c == '\\') escaped = true;
+                else if (c == '"') in_string = false;
+            } else if (c == '"') {
+                in_string = true;
+            } else if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (depth == 0) return false;
+                if (--depth == 0) return true;
+            }
+        }
+        return false;
+    }
+
+    std::shared_ptr<JsonDocument> doc_;
+    size_t consumed_ = 0;
+    size_t depth_ = 0;
+    bool complete_ = false;
+};
+
+}
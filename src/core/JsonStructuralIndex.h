@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include <memory_resource>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LCHBOT_JSON_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LCHBOT_JSON_SSE2 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace LCHBOT {
+
+class JsonStructuralIndex {
+public:
+    struct BlockMasks {
+        uint64_t quote = 0;
+        uint64_t backslash = 0;
+        uint64_t op = 0;
+        uint64_t whitespace = 0;
+    };
+
+    explicit JsonStructuralIndex(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : positions_(resource) {}
+
+    static const char* backend() {
+#if defined(LCHBOT_JSON_AVX2)
+        return "avx2";
+#elif defined(LCHBOT_JSON_SSE2)
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+
+    void build(std::string_view json) {
+        reset();
+        positions_.reserve(json.size() / 6 + 8);
+        finish(json);
+    }
+
+    void reset() {
+        positions_.clear();
+        processed_ = 0;
+        prev_escaped_ = 0;
+        prev_in_string_ = 0;
+        prev_scalar_ = 0;
+        finished_ = false;
+    }
+
+    void reserve(size_t json_size) {
+        positions_.reserve(json_size / 6 + 8);
+    }
+
+    void advance(std::string_view json) {
+        for (; processed_ + 64 <= json.size(); processed_ += 64) {
+            BlockMasks m = classify(json.data() + processed_);
+            processBlock(m, processed_);
+        }
+    }
+
+    void finish(std::string_view json) {
+        advance(json);
+
+        if (processed_ < json.size()) {
+            char tail[64];
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, json.data() + processed_, json.size() - processed_);
+            BlockMasks m = classify(tail);
+            processBlock(m, processed_);
+            processed_ = json.size();
+        }
+
+        if (prev_in_string_) {
+            throw std::runtime_error("Unterminated string");
+        }
+
+        positions_.push_back(static_cast<uint32_t>(json.size()));
+        finished_ = true;
+    }
+
+    size_t processed() const { return processed_; }
+    bool finished() const { return finished_; }
+    bool inString() const { return prev_in_string_ != 0; }
+    bool pendingEscape() const { return prev_escaped_ != 0; }
+
+    const std::pmr::vector<uint32_t>& positions() const { return positions_; }
+    size_t size() const { return positions_.size(); }
+    uint32_t operator[](size_t i) const { return positions_[i]; }
+
+    static BlockMasks classify(const char* block) {
+        BlockMasks m;
+#if defined(LCHBOT_JSON_AVX2)
+        for (int half = 0; half < 2; ++half) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + half * 32));
+            uint64_t shift = static_cast<uint64_t>(half) * 32;
+            m.quote |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))))) << shift;
+            m.backslash |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))))) << shift;
+            __m256i op = _mm256_or_si256(
+                _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('}'))),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('[')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(']')))),
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+            m.op |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(op))) << shift;
+            __m256i ws = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))),
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))));
+            m.whitespace |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(ws))) << shift;
+        }
+#elif defined(LCHBOT_JSON_SSE2)
+        for (int lane = 0; lane < 4; ++lane) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + lane * 16));
+            uint64_t shift = static_cast<uint64_t>(lane) * 16;
+            m.quote |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')))) << shift;
+            m.backslash |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\')))) << shift;
+            __m128i op = _mm_or_si128(
+                _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('{')), _mm_cmpeq_epi8(v, _mm_set1_epi8('}'))),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('[')), _mm_cmpeq_epi8(v, _mm_set1_epi8(']')))),
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+            m.op |= static_cast<uint64_t>(_mm_movemask_epi8(op)) << shift;
+            __m128i ws = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))));
+            m.whitespace |= static_cast<uint64_t>(_mm_movemask_epi8(ws)) << shift;
+        }
+#else
+        for (int i = 0; i < 64; ++i) {
+            uint64_t bit = 1ULL << i;
+            switch (block[i]) {
+                case '"': m.quote |= bit; break;
+                case '\\': m.backslash |= bit; break;
+                case '{': case '}': case '[': case ']': case ':': case ',': m.op |= bit; break;
+                case ' ': case '\n': case '\r': case '\t': m.whitespace |= bit; break;
+                default: break;
+            }
+        }
+#endif
+        return m;
+    }
+
+    static int trailingZeros(uint64_t x) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, x);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(x);
+#endif
+    }
+
+private:
+
+    static uint64_t prefixXor(uint64_t x) {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+
+    static uint64_t escapedChars(uint64_t backslash, uint64_t& prev_escaped) {
+        uint64_t escaped = prev_escaped;
+        prev_escaped = 0;
+        uint64_t pending = backslash & ~escaped;
+        while (pending) {
+            int i = trailingZeros(pending);
+            if (i == 63) {
+                prev_escaped = 1;
+            } else {
+                escaped |= 1ULL << (i + 1);
+            }
+            pending &= ~(1ULL << i);
+            pending &= ~escaped;
+        }
+        return escaped;
+    }
+
+    void processBlock(const BlockMasks& m, size_t offset) {
+        uint64_t escaped = (m.backslash || prev_escaped_) ? escapedChars(m.backslash, prev_escaped_) : 0;
+        uint64_t quotes = m.quote & ~escaped;
+        uint64_t in_string = prefixXor(quotes) ^ prev_in_string_;
+        prev_in_string_ = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+        uint64_t scalar = ~(m.whitespace | m.op | quotes | in_string);
+        uint64_t scalar_starts = scalar & ~((scalar << 1) | prev_scalar_);
+        prev_scalar_ = scalar >> 63;
+
+        uint64_t structural = (m.op & ~in_string) | quotes | scalar_starts;
+        while (structural) {
+            positions_.push_back(static_cast<uint32_t>(offset + trailingZeros(structural)));
+            structural &= structural - 1;
+        }
+    }
+
+    std::pmr::vector<uint32_t> positions_;
+    size_t processed_ = 0;
+    uint64_t prev_escaped_ = 0;
+    uint64_t prev_in_string_ = 0;
+    uint64_t prev_scalar_ = 0;
+    bool finished_ = false;
+};
+
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "Types.h"
+#include "TextEscape.h"
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace LCHBOT {
+
+class JsonWriter {
+public:
+    JsonWriter() : out_(&owned_) {}
+
+    explicit JsonWriter(std::string& out, bool pretty = false) : out_(&out), pretty_(pretty) {}
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void setPretty(bool pretty) { pretty_ = pretty; }
+    void setIndent(int indent) { indent_ = indent; }
+
+    std::string& buffer() { return *out_; }
+    const std::string& str() const { return *out_; }
+    std::string take() { return std::move(*out_); }
+
+    void clear() {
+        out_->clear();
+        depth_ = 0;
+        need_comma_ = false;
+        after_key_ = false;
+    }
+
+    void reserve(size_t n) { out_->reserve(n); }
+
+    JsonWriter& beginObject() {
+        beforeValue();
+        out_->push_back('{');
+        ++depth_;
+        need_comma_ = false;
+        return *this;
+    }
+
+    JsonWriter& endObject() { return endContainer('}'); }
+
+    JsonWriter& beginArray() {
+        beforeValue();
+        out_->push_back('[');
+        ++depth_;
+        need_comma_ = false;
+        return *this;
+    }
+
+    JsonWriter& endArray() { return endContainer(']'); }
+
+    JsonWriter& key(std::string_view k) {
+        if (need_comma_) out_->push_back(',');
+        if (pretty_) newline(depth_);
+        out_->push_back('"');
+        escape(*out_, k);
+        out_->append(pretty_ ? "\": " : "\":");
+        need_comma_ = false;
+        after_key_ = true;
+        return *this;
+    }
+
+    JsonWriter& null() {
+        beforeValue();
+        out_->append("null");
+        need_comma_ = true;
+        return *this;
+    }
+
+    JsonWriter& value(std::nullptr_t) { return null(); }
+
+    JsonWriter& value(bool b) {
+        beforeValue();
+        out_->append(b ? "true" : "false");
+        need_comma_ = true;
+        return *this;
+    }
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    JsonWriter& value(T n) {
+        beforeValue();
+        appendNumber(*out_, n);
+        need_comma_ = true;
+        return *this;
+    }
+
+    JsonWriter& value(double d) {
+        beforeValue();
+        appendNumber(*out_, d);
+        need_comma_ = true;
+        return *this;
+    }
+
+    JsonWriter& value(float f) { return value(static_cast<double>(f)); }
+
+    JsonWriter& value(std::string_view s) {
+        beforeValue();
+        out_->push_back('"');
+        escape(*out_, s);
+        out_->push_back('"');
+        need_comma_ = true;
+        return *this;
+    }
+
+    JsonWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+
+    JsonWriter& value(const JsonValue& v) {
+        if (v.isNull()) {
+            null();
+        } else if (v.isBool()) {
+            value(v.asBool());
+        } else if (v.isInt()) {
+            value(v.asInt());
+        } else if (v.isDouble()) {
+            value(v.asDouble());
+        } else if (v.isString()) {
+            value(std::string_view(v.asString()));
+        } else if (v.isBigNumber()) {
+            rawValue(v.asBigNumber().text);
+        } else if (v.isArray()) {
+            beginArray();
+            for (const auto& item : v.asArray()) {
+                value(item);
+            }
+            endArray();
+        } else if (v.isObject()) {
+            beginObject();
+            for (const auto& [k, item] : v.asObject()) {
+                key(k);
+                value(item);
+            }
+            endObject();
+        }
+        return *this;
+    }
+
+    JsonWriter& rawValue(std::string_view json) {
+        beforeValue();
+        out_->append(json.data(), json.size());
+        need_comma_ = true;
+        return *this;
+    }
+
+    template <typename T>
+    JsonWriter& field(std::string_view k, T&& v) {
+        key(k);
+        return value(std::forward<T>(v));
+    }
+
+    JsonWriter& rawField(std::string_view k, std::string_view json) {
+        key(k);
+        return rawValue(json);
+    }
+
+    static void escape(std::string& out, std::string_view s) {
+        TextEscape::append(out, s, EscapeStyle::Json);
+    }
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+    static void appendNumber(std::string& out, T n) {
+        char buf[24];
+        auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), n);
+        out.append(buf, ptr - buf);
+    }
+
+    static void appendNumber(std::string& out, double d) {
+        if (!std::isfinite(d)) {
+            out.append("null");
+            return;
+        }
+        char buf[32];
+        auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), d);
+        out.append(buf, ptr - buf);
+    }
+
+private:
+    void beforeValue() {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (need_comma_) out_->push_back(',');
+        if (pretty_ && depth_ > 0) newline(depth_);
+    }
+
+    JsonWriter& endContainer(char close) {
+        --depth_;
+        if (pretty_ && need_comma_) newline(depth_);
+        out_->push_back(close);
+        need_comma_ = true;
+        return *this;
+    }
+
+    void newline(int depth) {
+        out_->push_back('\n');
+        out_->append(static_cast<size_t>(indent_ + depth) * 2, ' ');
+    }
+
+    std::string owned_;
+    std::string* out_;
+    bool pretty_ = false;
+    int indent_ = 0;
+    int depth_ = 0;
+    bool need_comma_ = false;
+    bool after_key_ = false;
+};
+
+}
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace LCHBOT {
+
+enum class Key : uint32_t {
+    None = 0,
+    PostType,
+    MessageType,
+    NoticeType,
+    RequestType,
+    MetaEventType,
+    SubType,
+    Time,
+    SelfId,
+    MessageId,
+    MessageSeq,
+    RealId,
+    UserId,
+    GroupId,
+    TargetId,
+    OperatorId,
+    RawMessage,
+    Message,
+    Font,
+    Sender,
+    Anonymous,
+    Nickname,
+    Card,
+    Sex,
+    Age,
+    Area,
+    Level,
+    Role,
+    Title,
+    Comment,
+    Flag,
+    Duration,
+    Interval,
+    Status,
+    Retcode,
+    Msg,
+    Wording,
+    Data,
+    Echo,
+    Action,
+    Params,
+    Type,
+    Text,
+    Id,
+    Qq,
+    File,
+    Url,
+    Content,
+    Image,
+    Name,
+    Size,
+    Busid,
+    AutoEscape,
+    GroupName,
+    MemberCount,
+    MaxMemberCount,
+    JoinTime,
+    LastSentTime,
+    Unfriendly,
+    TitleExpireTime,
+    CardChangeable,
+    Online,
+    Good,
+    Approve,
+    Remark,
+    Reason,
+    Enable,
+    NoCache,
+    Count
+};
+
+class KeyTable {
+public:
+    static constexpr std::string_view kNames[] = {
+        "",
+        "post_type",
+        "message_type",
+        "notice_type",
+        "request_type",
+        "meta_event_type",
+        "sub_type",
+        "time",
+        "self_id",
+        "message_id",
+        "message_seq",
+        "real_id",
+        "user_id",
+        "group_id",
+        "target_id",
+        "operator_id",
+        "raw_message",
+        "message",
+        "font",
+        "sender",
+        "anonymous",
+        "nickname",
+        "card",
+        "sex",
+        "age",
+        "area",
+        "level",
+        "role",
+        "title",
+        "comment",
+        "flag",
+        "duration",
+        "interval",
+        "status",
+        "retcode",
+        "msg",
+        "wording",
+        "data",
+        "echo",
+        "action",
+        "params",
+        "type",
+        "text",
+        "id",
+        "qq",
+        "file",
+        "url",
+        "content",
+        "image",
+        "name",
+        "size",
+        "busid",
+        "auto_escape",
+        "group_name",
+        "member_count",
+        "max_member_count",
+        "join_time",
+        "last_sent_time",
+        "unfriendly",
+        "title_expire_time",
+        "card_changeable",
+        "online",
+        "good",
+        "approve",
+        "remark",
+        "reason",
+        "enable",
+        "no_cache"
+    };
+
+    static constexpr uint32_t kCount = static_cast<uint32_t>(Key::Count);
+
+    static_assert(std::size(kNames) == kCount, "KeyTable names must match the Key enumeration");
+
+    static constexpr Key lookup(std::string_view name) {
+        uint32_t mask = static_cast<uint32_t>(kSlots.size() - 1);
+        for (uint32_t slot = hash(name) & mask; kSlots[slot] != 0; slot = (slot + 1) & mask) {
+            if (kNames[kSlots[slot]] == name) return static_cast<Key>(kSlots[slot]);
+        }
+        return Key::None;
+    }
+
+    static constexpr std::string_view name(Key atom) {
+        uint32_t id = static_cast<uint32_t>(atom);
+        return id < kCount ? kNames[id] : std::string_view();
+    }
+
+    static constexpr uint32_t hash(std::string_view s) {
+        uint32_t h = 2166136261u;
+        for (char c : s) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+private:
+    static constexpr std::array<uint8_t, 256> buildSlots() {
+        std::array<uint8_t, 256> slots{};
+        for (uint32_t id = 1; id < kCount; ++id) {
+            uint32_t slot = hash(kNames[id]) & (slots.size() - 1);
+            while (slots[slot] != 0) slot = (slot + 1) & (slots.size() - 1);
+            slots[slot] = static_cast<uint8_t>(id);
+        }
+        return slots;
+    }
+
+    static const std::array<uint8_t, 256> kSlots;
+};
+
+inline constexpr std::array<uint8_t, 256> KeyTable::kSlots = KeyTable::buildSlots();
+
+class JsonKey {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    JsonKey() = default;
+    explicit JsonKey(const allocator_type& alloc) : text_(alloc) {}
+
+    JsonKey(Key atom, const allocator_type& alloc = {}) : atom_(atom), text_(alloc) {
+        name_ = KeyTable::name(atom);
+    }
+
+    JsonKey(std::string_view text, const allocator_type& alloc = {}) : text_(alloc) { assign(text); }
+    JsonKey(const char* text, const allocator_type& alloc = {}) : text_(alloc) { assign(text); }
+    JsonKey(const std::string& text, const allocator_type& alloc = {}) : text_(alloc) { assign(text); }
+
+    JsonKey(const JsonKey& other) = default;
+    JsonKey(JsonKey&& other) noexcept = default;
+    JsonKey(const JsonKey& other, const allocator_type& alloc)
+        : atom_(other.atom_), name_(other.name_), text_(other.text_, alloc) {}
+    JsonKey(JsonKey&& other, const allocator_type& alloc)
+        : atom_(other.atom_), name_(other.name_), text_(std::move(other.text_), alloc) {}
+
+    JsonKey& operator=(const JsonKey& other) = default;
+    JsonKey& operator=(JsonKey&& other) = default;
+
+    Key atom() const { return atom_; }
+    bool interned() const { return atom_ != Key::None; }
+
+    std::string_view view() const {
+        return atom_ != Key::None ? name_ : std::string_view(text_);
+    }
+
+    operator std::string_view() const { return view(); }
+
+    std::string str() const { return std::string(view()); }
+
+    size_t hash() const { return std::hash<std::string_view>{}(view()); }
+
+    friend bool operator==(const JsonKey& a, const JsonKey& b) {
+        if (a.atom_ != Key::None && b.atom_ != Key::None) return a.atom_ == b.atom_;
+        return a.view() == b.view();
+    }
+
+    friend bool operator==(const JsonKey& a, Key atom) {
+        return atom != Key::None && a.atom_ == atom;
+    }
+
+    template <typename S, std::enable_if_t<std::is_convertible_v<const S&, std::string_view> && !std::is_same_v<S, JsonKey>, int> = 0>
+    friend bool operator==(const JsonKey& a, const S& s) {
+        return a.view() == std::string_view(s);
+    }
+
+private:
+    void assign(std::string_view text) {
+        atom_ = KeyTable::lookup(text);
+        if (atom_ != Key::None) {
+            name_ = KeyTable::name(atom_);
+        } else {
+            text_.assign(text.data(), text.size());
+        }
+    }
+
+    Key atom_ = Key::None;
+    std::string_view name_;
+    std::pmr::string text_;
+};
+
+struct JsonKeyLess {
+    using is_transparent = void;
+
+    bool operator()(const JsonKey& a, const JsonKey& b) const {
+        if (a.atom() != Key::None && a.atom() == b.atom()) return false;
+        return a.view() < b.view();
+    }
+
+    bool operator()(const JsonKey& a, Key b) const {
+        if (a.atom() == b) return false;
+        return a.view() < KeyTable::name(b);
+    }
+
+    bool operator()(Key a, const JsonKey& b) const {
+        if (a == b.atom()) return false;
+        return KeyTable::name(a) < b.view();
+    }
+
+    template <typename S, std::enable_if_t<std::is_convertible_v<const S&, std::string_view> && !std::is_same_v<S, JsonKey>, int> = 0>
+    bool operator()(const JsonKey& a, const S& b) const {
+        return a.view() < std::string_view(b);
+    }
+
+    template <typename S, std::enable_if_t<std::is_convertible_v<const S&, std::string_view> && !std::is_same_v<S, JsonKey>, int> = 0>
+    bool operator()(const S& a, const JsonKey& b) const {
+        return std::string_view(a) < b.view();
+    }
+};
+
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "WorkerPool.h"
+
+namespace LCHBOT {
+
+class KeyedExecutor {
+public:
+    using Task = WorkerPool::Task;
+
+    static uint64_t groupKey(int64_t group_id) { return static_cast<uint64_t>(group_id) << 1; }
+    static uint64_t privateKey(int64_t user_id) { return (static_cast<uint64_t>(user_id) << 1) | 1; }
+
+    explicit KeyedExecutor(WorkerPool& pool, size_t shards = 0, size_t capacity = 0,
+                           OverflowPolicy policy = OverflowPolicy::Block)
+        : gate_(std::make_shared<Gate>()) {
+        if (shards == 0) shards = std::max<size_t>(1, pool.threads());
+        gate_->capacity = capacity;
+        gate_->policy = policy;
+        shards_.reserve(shards);
+        for (size_t i = 0; i < shards; ++i) {
+            shards_.push_back(std::make_shared<Strand>(pool));
+        }
+    }
+
+    bool submit(uint64_t key, Task task) { return admit(key, std::move(task), true); }
+
+    bool trySubmit(uint64_t key, Task task) { return admit(key, std::move(task), false); }
+
+    size_t shardOf(uint64_t key) const {
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ull;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebull;
+        key ^= key >> 31;
+        return static_cast<size_t>(key % shards_.size());
+    }
+
+    size_t shards() const { return shards_.size(); }
+
+    bool appliesBackpressure() const { return gate_->waits(); }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(gate_->mutex);
+        return gate_->in_flight;
+    }
+
+    std::string exportPrometheus(const std::string& name = "dispatch") const {
+        size_t busiest = 0;
+        for (const auto& shard : shards_) busiest = std::max(busiest, shard->pending());
+
+        uint64_t submitted, rejected, deferred;
+        size_t in_flight, max_in_flight;
+        {
+            std::lock_guard<std::mutex> lock(gate_->mutex);
+            submitted = gate_->submitted;
+            rejected = gate_->rejected;
+            deferred = gate_->deferred;
+            in_flight = gate_->in_flight;
+            max_in_flight = gate_->max_in_flight;
+        }
+
+        std::ostringstream ss;
+        std::string prefix = "lchbot_" + name + "_";
+        ss << "# HELP " << prefix << "shards Ordered dispatch shards\n";
+        ss << "# TYPE " << prefix << "shards gauge\n";
+        ss << prefix << "shards " << shards_.size() << "\n\n";
+        ss << "# HELP " << prefix << "in_flight Events queued or running across all shards\n";
+        ss << "# TYPE " << prefix << "in_flight gauge\n";
+        ss << prefix << "in_flight " << in_flight << "\n\n";
+        ss << "# HELP " << prefix << "max_in_flight Highest observed number of in-flight events\n";
+        ss << "# TYPE " << prefix << "max_in_flight gauge\n";
+        ss << prefix << "max_in_flight " << max_in_flight << "\n\n";
+        ss << "# HELP " << prefix << "busiest_shard_depth Events waiting in the most loaded shard\n";
+        ss << "# TYPE " << prefix << "busiest_shard_depth gauge\n";
+        ss << prefix << "busiest_shard_depth " << busiest << "\n\n";
+        ss << "# HELP " << prefix << "events_total Events by admission outcome\n";
+        ss << "# TYPE " << prefix << "events_total counter\n";
+        ss << prefix << "events_total{outcome=\"accepted\"} " << submitted << "\n";
+        ss << prefix << "events_total{outcome=\"rejected\"} " << rejected << "\n";
+        ss << prefix << "events_total{outcome=\"deferred\"} " << deferred << "\n\n";
+        return ss.str();
+    }
+
+private:
+    bool admit(uint64_t key, Task task, bool may_wait) {
+        if (!gate_->acquire(may_wait)) return false;
+        shards_[shardOf(key)]->post([gate = gate_, task = std::move(task)] {
+            WorkerPool::runTask(task);
+            gate->release();
+        });
+        return true;
+    }
+
+    struct Gate {
+        std::mutex mutex;
+        std::condition_variable released;
+        size_t capacity = 0;
+        OverflowPolicy policy = OverflowPolicy::Block;
+        size_t in_flight = 0;
+        size_t max_in_flight = 0;
+        uint64_t submitted = 0;
+        uint64_t rejected = 0;
+        uint64_t deferred = 0;
+
+        bool waits() const { return policy == OverflowPolicy::Block || policy == OverflowPolicy::CallerRuns; }
+
+        bool acquire(bool may_wait) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (capacity > 0 && in_flight >= capacity) {
+                if (!waits()) {
+                    ++rejected;
+                    return false;
+                }
+                if (!may_wait) {
+                    ++deferred;
+                    return false;
+                }
+                released.wait(lock, [this] { return in_flight < capacity; });
+            }
+            ++in_flight;
+            ++submitted;
+            max_in_flight = std::max(max_in_flight, in_flight);
+            return true;
+        }
+
+        void release() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --in_flight;
+            }
+            released.notify_one();
+        }
+    };
+
+    std::shared_ptr<Gate> gate_;
+    std::vector<std::shared_ptr<Strand>> shards_;
+};
+
+}
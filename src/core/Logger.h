@@ -195,8 +195,8 @@ private:
         }
     }
     
-    WORD getWindowsColor(LogLevel level) {
 #ifdef _WIN32
+    WORD getWindowsColor(LogLevel level) {
         switch (level) {
             case LogLevel::Trace: return FOREGROUND_INTENSITY;
             case LogLevel::Debug: return FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY;
@@ -207,10 +207,8 @@ private:
             case LogLevel::Message: return FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY;
             default: return FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
         }
-#else
-        return 0;
-#endif
     }
+#endif
     
     void openLogFile() {
         auto now = std::chrono::system_clock::now();
@@ -0,0 +1,491 @@
+#pragma once
+
+#include "Types.h"
+#include <string>
+#include <string_view>
+#include <optional>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace LCHBOT {
+
+enum class WireFormat {
+    Json,
+    MessagePack
+};
+
+class MsgPackWriter {
+public:
+    static constexpr int8_t kBigNumberExt = 1;
+
+    MsgPackWriter() : out_(&owned_) {}
+
+    explicit MsgPackWriter(std::string& out) : out_(&out) {}
+
+    MsgPackWriter(const MsgPackWriter&) = delete;
+    MsgPackWriter& operator=(const MsgPackWriter&) = delete;
+
+    std::string& buffer() { return *out_; }
+    const std::string& str() const { return *out_; }
+    std::string take() { return std::move(*out_); }
+
+    void clear() { out_->clear(); }
+    void reserve(size_t n) { out_->reserve(n); }
+
+    MsgPackWriter& beginArray(uint32_t count) {
+        if (count < 16) {
+            put(static_cast<uint8_t>(0x90 | count));
+        } else if (count <= 0xFFFF) {
+            put(0xDC);
+            putBig(static_cast<uint16_t>(count));
+        } else {
+            put(0xDD);
+            putBig(count);
+        }
+        return *this;
+    }
+
+    MsgPackWriter& beginMap(uint32_t count) {
+        if (count < 16) {
+            put(static_cast<uint8_t>(0x80 | count));
+        } else if (count <= 0xFFFF) {
+            put(0xDE);
+            putBig(static_cast<uint16_t>(count));
+        } else {
+            put(0xDF);
+            putBig(count);
+        }
+        return *this;
+    }
+
+    MsgPackWriter& key(std::string_view k) { return value(k); }
+
+    MsgPackWriter& null() {
+        put(0xC0);
+        return *this;
+    }
+
+    MsgPackWriter& value(std::nullptr_t) { return null(); }
+
+    MsgPackWriter& value(bool b) {
+        put(b ? 0xC3 : 0xC2);
+        return *this;
+    }
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    MsgPackWriter& value(T n) {
+        if constexpr (std::is_signed_v<T>) {
+            if (n < 0) {
+                writeNegative(static_cast<int64_t>(n));
+                return *this;
+            }
+        }
+        writeUnsigned(static_cast<uint64_t>(n));
+        return *this;
+    }
+
+    MsgPackWriter& value(double d) {
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        put(0xCB);
+        putBig(bits);
+        return *this;
+    }
+
+    MsgPackWriter& value(float f) { return value(static_cast<double>(f)); }
+
+    MsgPackWriter& value(std::string_view s) {
+        size_t n = s.size();
+        if (n < 32) {
+            put(static_cast<uint8_t>(0xA0 | n));
+        } else if (n <= 0xFF) {
+            put(0xD9);
+            put(static_cast<uint8_t>(n));
+        } else if (n <= 0xFFFF) {
+            put(0xDA);
+            putBig(static_cast<uint16_t>(n));
+        } else {
+            put(0xDB);
+            putBig(static_cast<uint32_t>(n));
+        }
+        out_->append(s.data(), s.size());
+        return *this;
+    }
+
+    MsgPackWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    MsgPackWriter& value(const char* s) { return value(std::string_view(s)); }
+
+    MsgPackWriter& value(const JsonValue& v) {
+        if (v.isNull()) {
+            null();
+        } else if (v.isBool()) {
+            value(v.asBool());
+        } else if (v.isInt()) {
+            value(v.asInt());
+        } else if (v.isDouble()) {
+            value(v.asDouble());
+        } else if (v.isString()) {
+            value(std::string_view(v.asString()));
+        } else if (v.isBigNumber()) {
+            extension(kBigNumberExt, v.asBigNumber().text);
+        } else if (v.isArray()) {
+            const auto& arr = v.asArray();
+            beginArray(static_cast<uint32_t>(arr.size()));
+            for (const auto& item : arr) {
+                value(item);
+            }
+        } else if (v.isObject()) {
+            const auto& obj = v.asObject();
+            beginMap(static_cast<uint32_t>(obj.size()));
+            for (const auto& [k, item] : obj) {
+                key(k);
+                value(item);
+            }
+        }
+        return *this;
+    }
+
+    MsgPackWriter& extension(int8_t type, std::string_view payload) {
+        size_t n = payload.size();
+        if (n <= 0xFF) {
+            put(0xC7);
+            put(static_cast<uint8_t>(n));
+        } else if (n <= 0xFFFF) {
+            put(0xC8);
+            putBig(static_cast<uint16_t>(n));
+        } else {
+            put(0xC9);
+            putBig(static_cast<uint32_t>(n));
+        }
+        put(static_cast<uint8_t>(type));
+        out_->append(payload.data(), payload.size());
+        return *this;
+    }
+
+    template <typename T>
+    MsgPackWriter& field(std::string_view k, T&& v) {
+        key(k);
+        return value(std::forward<T>(v));
+    }
+
+private:
+    void put(uint8_t b) { out_->push_back(static_cast<char>(b)); }
+
+    template <typename T>
+    void putBig(T v) {
+        char buf[sizeof(T)];
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            buf[i] = static_cast<char>(static_cast<uint8_t>(v >> (8 * (sizeof(T) - 1 - i))));
+        }
+        out_->append(buf, sizeof(T));
+    }
+
+    void writeUnsigned(uint64_t n) {
+        if (n < 0x80) {
+            put(static_cast<uint8_t>(n));
+        } else if (n <= 0xFF) {
+            put(0xCC);
+            put(static_cast<uint8_t>(n));
+        } else if (n <= 0xFFFF) {
+            put(0xCD);
+            putBig(static_cast<uint16_t>(n));
+        } else if (n <= 0xFFFFFFFFull) {
+            put(0xCE);
+            putBig(static_cast<uint32_t>(n));
+        } else {
+            put(0xCF);
+            putBig(n);
+        }
+    }
+
+    void writeNegative(int64_t n) {
+        if (n >= -32) {
+            put(static_cast<uint8_t>(n));
+        } else if (n >= std::numeric_limits<int8_t>::min()) {
+            put(0xD0);
+            put(static_cast<uint8_t>(n));
+        } else if (n >= std::numeric_limits<int16_t>::min()) {
+            put(0xD1);
+            putBig(static_cast<uint16_t>(n));
+        } else if (n >= std::numeric_limits<int32_t>::min()) {
+            put(0xD2);
+            putBig(static_cast<uint32_t>(n));
+        } else {
+            put(0xD3);
+            putBig(static_cast<uint64_t>(n));
+        }
+    }
+
+    std::string owned_;
+    std::string* out_;
+};
+
+class MsgPackReader {
+public:
+    static constexpr size_t kMaxDepth = 512;
+
+    MsgPackReader() = default;
+
+    explicit MsgPackReader(std::string_view data) : buffer_(data) {}
+
+    void feed(std::string_view chunk) {
+        if (pos_ > 0 && pos_ * 2 >= buffer_.size()) {
+            buffer_.erase(0, pos_);
+            scan_ -= pos_;
+            pos_ = 0;
+        }
+        buffer_.append(chunk.data(), chunk.size());
+    }
+
+    size_t pending() const { return buffer_.size() - pos_; }
+    bool empty() const { return pos_ >= buffer_.size(); }
+
+    void reset() {
+        buffer_.clear();
+        pos_ = 0;
+        scan_ = 0;
+        open_.clear();
+    }
+
+    std::optional<JsonValue> next() {
+        if (!scanValue()) return std::nullopt;
+        size_t pos = pos_;
+        JsonValue v = decode(pos, 0);
+        pos_ = scan_;
+        return v;
+    }
+
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    uint8_t byteAt(size_t pos) const { return static_cast<uint8_t>(buffer_[pos]); }
+
+    template <typename T>
+    T readBig(size_t pos) const {
+        T v = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            v = static_cast<T>((v << 8) | byteAt(pos + i));
+        }
+        return v;
+    }
+
+    bool has(size_t pos, size_t n) const { return pos <= buffer_.size() && buffer_.size() - pos >= n; }
+
+    bool scanValue() {
+        if (scan_ < pos_) scan_ = pos_;
+        while (true) {
+            size_t items = 0;
+            size_t end = header(scan_, items);
+            if (end == npos) return false;
+            scan_ = end;
+            if (items > 0) {
+                if (open_.size() >= kMaxDepth) throw std::runtime_error("MessagePack nesting too deep");
+                open_.push_back(items);
+                continue;
+            }
+            while (!open_.empty() && --open_.back() == 0) open_.pop_back();
+            if (open_.empty()) return true;
+        }
+    }
+
+    size_t header(size_t pos, size_t& items) const {
+        if (!has(pos, 1)) return npos;
+        uint8_t b = byteAt(pos);
+
+        if (b <= 0x7F || b >= 0xE0 || (b >= 0xC0 && b <= 0xC3)) return pos + 1;
+        if ((b & 0xE0) == 0xA0) return sized(pos + 1, b & 0x1F);
+        if ((b & 0xF0) == 0x90) {
+            items = b & 0x0F;
+            return pos + 1;
+        }
+        if ((b & 0xF0) == 0x80) {
+            items = static_cast<size_t>(b & 0x0F) * 2;
+            return pos + 1;
+        }
+
+        switch (b) {
+            case 0xCC: case 0xD0: return sized(pos + 1, 1);
+            case 0xCD: case 0xD1: return sized(pos + 1, 2);
+            case 0xCE: case 0xD2: case 0xCA: return sized(pos + 1, 4);
+            case 0xCF: case 0xD3: case 0xCB: return sized(pos + 1, 8);
+            case 0xD9: case 0xC4: return has(pos + 1, 1) ? sized(pos + 2, byteAt(pos + 1)) : npos;
+            case 0xDA: case 0xC5: return has(pos + 1, 2) ? sized(pos + 3, readBig<uint16_t>(pos + 1)) : npos;
+            case 0xDB: case 0xC6: return has(pos + 1, 4) ? sized(pos + 5, readBig<uint32_t>(pos + 1)) : npos;
+            case 0xD4: return sized(pos + 2, 1);
+            case 0xD5: return sized(pos + 2, 2);
+            case 0xD6: return sized(pos + 2, 4);
+            case 0xD7: return sized(pos + 2, 8);
+            case 0xD8: return sized(pos + 2, 16);
+            case 0xC7: return has(pos + 1, 1) ? sized(pos + 3, byteAt(pos + 1)) : npos;
+            case 0xC8: return has(pos + 1, 2) ? sized(pos + 4, readBig<uint16_t>(pos + 1)) : npos;
+            case 0xC9: return has(pos + 1, 4) ? sized(pos + 6, readBig<uint32_t>(pos + 1)) : npos;
+            case 0xDC:
+                if (!has(pos + 1, 2)) return npos;
+                items = readBig<uint16_t>(pos + 1);
+                return pos + 3;
+            case 0xDD:
+                if (!has(pos + 1, 4)) return npos;
+                items = readBig<uint32_t>(pos + 1);
+                return pos + 5;
+            case 0xDE:
+                if (!has(pos + 1, 2)) return npos;
+                items = static_cast<size_t>(readBig<uint16_t>(pos + 1)) * 2;
+                return pos + 3;
+            case 0xDF:
+                if (!has(pos + 1, 4)) return npos;
+                items = static_cast<size_t>(readBig<uint32_t>(pos + 1)) * 2;
+                return pos + 5;
+            default: break;
+        }
+        throw std::runtime_error("Invalid MessagePack type byte");
+    }
+
+    size_t sized(size_t pos, size_t n) const {
+        return has(pos, n) ? pos + n : npos;
+    }
+
+    std::string_view bytes(size_t& pos, size_t n) const {
+        std::string_view s(buffer_.data() + pos, n);
+        pos += n;
+        return s;
+    }
+
+    static JsonValue fromUnsigned(uint64_t n) {
+        if (n <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+            return JsonValue(static_cast<int64_t>(n));
+        }
+        char buf[24];
+        auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), n);
+        return JsonValue(JsonBigNumber{std::string(buf, ptr - buf)});
+    }
+
+    static double toDouble(uint64_t bits) {
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+
+    static float toFloat(uint32_t bits) {
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    JsonValue decodeArray(size_t& pos, size_t count, size_t depth) const {
+        std::vector<JsonValue> arr;
+        arr.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            arr.push_back(decode(pos, depth + 1));
+        }
+        return JsonValue(std::move(arr));
+    }
+
+    JsonValue decodeMap(size_t& pos, size_t count, size_t depth) const {
+        JsonObject obj;
+        obj.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            JsonValue k = decode(pos, depth + 1);
+            JsonKey key;
+            if (k.isString()) {
+                key = JsonKey(k.asString());
+            } else if (k.isInt()) {
+                key = JsonKey(std::to_string(k.asInt()));
+            } else {
+                throw std::runtime_error("Unsupported MessagePack map key");
+            }
+            obj.insert_or_assign(std::move(key), decode(pos, depth + 1));
+        }
+        return JsonValue(std::move(obj));
+    }
+
+    JsonValue decodeExtension(size_t& pos, size_t n) const {
+        int8_t type = static_cast<int8_t>(byteAt(pos++));
+        std::string_view payload = bytes(pos, n);
+        if (type == MsgPackWriter::kBigNumberExt) {
+            return JsonValue(JsonBigNumber{std::string(payload)});
+        }
+        throw std::runtime_error("Unsupported MessagePack extension type");
+    }
+
+    JsonValue decode(size_t& pos, size_t depth) const {
+        uint8_t b = byteAt(pos++);
+
+        if (b <= 0x7F) return JsonValue(static_cast<int64_t>(b));
+        if (b >= 0xE0) return JsonValue(static_cast<int64_t>(static_cast<int8_t>(b)));
+        if ((b & 0xE0) == 0xA0) return JsonValue(bytes(pos, b & 0x1F));
+        if ((b & 0xF0) == 0x90) return decodeArray(pos, b & 0x0F, depth);
+        if ((b & 0xF0) == 0x80) return decodeMap(pos, b & 0x0F, depth);
+
+        size_t n = 0;
+        switch (b) {
+            case 0xC0: return JsonValue(nullptr);
+            case 0xC2: return JsonValue(false);
+            case 0xC3: return JsonValue(true);
+            case 0xCC: return JsonValue(static_cast<int64_t>(byteAt(pos++)));
+            case 0xCD: pos += 2; return JsonValue(static_cast<int64_t>(readBig<uint16_t>(pos - 2)));
+            case 0xCE: pos += 4; return JsonValue(static_cast<int64_t>(readBig<uint32_t>(pos - 4)));
+            case 0xCF: pos += 8; return fromUnsigned(readBig<uint64_t>(pos - 8));
+            case 0xD0: return JsonValue(static_cast<int64_t>(static_cast<int8_t>(byteAt(pos++))));
+            case 0xD1: pos += 2; return JsonValue(static_cast<int64_t>(static_cast<int16_t>(readBig<uint16_t>(pos - 2))));
+            case 0xD2: pos += 4; return JsonValue(static_cast<int64_t>(static_cast<int32_t>(readBig<uint32_t>(pos - 4))));
+            case 0xD3: pos += 8; return JsonValue(static_cast<int64_t>(readBig<uint64_t>(pos - 8)));
+            case 0xCA: pos += 4; return JsonValue(static_cast<double>(toFloat(readBig<uint32_t>(pos - 4))));
+            case 0xCB: pos += 8; return JsonValue(toDouble(readBig<uint64_t>(pos - 8)));
+            case 0xD9: case 0xC4: n = byteAt(pos); pos += 1; return JsonValue(bytes(pos, n));
+            case 0xDA: case 0xC5: n = readBig<uint16_t>(pos); pos += 2; return JsonValue(bytes(pos, n));
+            case 0xDB: case 0xC6: n = readBig<uint32_t>(pos); pos += 4; return JsonValue(bytes(pos, n));
+            case 0xDC: n = readBig<uint16_t>(pos); pos += 2; return decodeArray(pos, n, depth);
+            case 0xDD: n = readBig<uint32_t>(pos); pos += 4; return decodeArray(pos, n, depth);
+            case 0xDE: n = readBig<uint16_t>(pos); pos += 2; return decodeMap(pos, n, depth);
+            case 0xDF: n = readBig<uint32_t>(pos); pos += 4; return decodeMap(pos, n, depth);
+            case 0xD4: return decodeExtension(pos, 1);
+            case 0xD5: return decodeExtension(pos, 2);
+            case 0xD6: return decodeExtension(pos, 4);
+            case 0xD7: return decodeExtension(pos, 8);
+            case 0xD8: return decodeExtension(pos, 16);
+            case 0xC7: n = byteAt(pos); pos += 1; return decodeExtension(pos, n);
+            case 0xC8: n = readBig<uint16_t>(pos); pos += 2; return decodeExtension(pos, n);
+            case 0xC9: n = readBig<uint32_t>(pos); pos += 4; return decodeExtension(pos, n);
+            default: break;
+        }
+        throw std::runtime_error("Invalid MessagePack type byte");
+    }
+
+    std::string buffer_;
+    size_t pos_ = 0;
+    size_t scan_ = 0;
+    std::vector<size_t> open_;
+};
+
+class MessagePack {
+public:
+    static std::string encode(const JsonValue& value) {
+        MsgPackWriter writer;
+        writer.value(value);
+        return writer.take();
+    }
+
+    static JsonValue decode(std::string_view data) {
+        MsgPackReader reader(data);
+        auto value = reader.next();
+        if (!value) {
+            throw std::runtime_error("Unexpected end of MessagePack data");
+        }
+        if (!reader.empty()) {
+            throw std::runtime_error("Unexpected trailing MessagePack data");
+        }
+        return std::move(*value);
+    }
+
+    static bool looksLikeMessagePack(std::string_view data) {
+        if (data.empty()) return false;
+        uint8_t b = static_cast<uint8_t>(data[0]);
+        return (b & 0xF0) == 0x80 || (b & 0xF0) == 0x90 || (b >= 0xDC && b <= 0xDF);
+    }
+};
+
+}
@@ -9,6 +9,9 @@
 #include <fstream>
 #include <filesystem>
 #include "JsonParser.h"
+#include "JsonWriter.h"
+#include "MessagePack.h"
+#include "Config.h"
 #include "Logger.h"
 
 namespace lchbot {
@@ -78,7 +81,10 @@ public:
     
 private:
     MessageQueue() : running_(false) {
-        queue_file_ = "data/message_queue.json";
+        format_ = LCHBOT::ConfigManager::instance().config().internal_format == "msgpack"
+            ? LCHBOT::WireFormat::MessagePack
+            : LCHBOT::WireFormat::Json;
+        queue_file_ = pathFor(format_);
         std::filesystem::create_directories("data");
     }
     
@@ -120,51 +126,64 @@ private:
         }
     }
     
+    static std::string pathFor(LCHBOT::WireFormat format) {
+        return format == LCHBOT::WireFormat::MessagePack ? "data/message_queue.msgpack" : "data/message_queue.json";
+    }
+    
     void persistToFile() {
         try {
-            std::ofstream file(queue_file_);
-            if (!file) return;
-            
-            file << "[";
+            std::string data;
             std::queue<QueuedMessage> temp = queue_;
-            bool first = true;
-            while (!temp.empty()) {
-                if (!first) file << ",";
-                first = false;
-                auto& m = temp.front();
-                file << "{\"action\":\"" << m.action 
-                     << "\",\"target_id\":" << m.target_id
-                     << ",\"message\":\"";
-                for (char c : m.message) {
-                    if (c == '"') file << "\\\"";
-                    else if (c == '\\') file << "\\\\";
-                    else if (c == '\n') file << "\\n";
-                    else if (c == '\r') file << "\\r";
-                    else if (c == '\t') file << "\\t";
-                    else if (static_cast<unsigned char>(c) < 0x20) {
-                        char buf[8];
-                        snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
-                        file << buf;
-                    }
-                    else file << c;
+            if (format_ == LCHBOT::WireFormat::MessagePack) {
+                LCHBOT::MsgPackWriter writer(data);
+                writer.beginArray(static_cast<uint32_t>(temp.size()));
+                while (!temp.empty()) {
+                    auto& m = temp.front();
+                    writer.beginMap(4);
+                    writer.field("action", m.action);
+                    writer.field("target_id", m.target_id);
+                    writer.field("message", m.message);
+                    writer.field("timestamp", m.timestamp);
+                    temp.pop();
                 }
-                file << "\",\"timestamp\":" << m.timestamp << "}";
-                temp.pop();
+            } else {
+                LCHBOT::JsonWriter writer(data);
+                writer.beginArray();
+                while (!temp.empty()) {
+                    auto& m = temp.front();
+                    writer.beginObject();
+                    writer.field("action", m.action);
+                    writer.field("target_id", m.target_id);
+                    writer.field("message", m.message);
+                    writer.field("timestamp", m.timestamp);
+                    writer.endObject();
+                    temp.pop();
+                }
+                writer.endArray();
             }
-            file << "]";
+            
+            std::ofstream file(queue_file_, std::ios::binary);
+            if (!file) return;
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
         } catch (...) {}
     }
     
     void loadFromFile() {
         try {
-            std::ifstream file(queue_file_);
+            std::string path = queue_file_;
+            if (!std::filesystem::exists(path)) {
+                path = pathFor(format_ == LCHBOT::WireFormat::MessagePack ? LCHBOT::WireFormat::Json : LCHBOT::WireFormat::MessagePack);
+            }
+            std::ifstream file(path, std::ios::binary);
             if (!file) return;
             
             std::string content((std::istreambuf_iterator<char>(file)),
                                std::istreambuf_iterator<char>());
             if (content.empty() || content == "[]") return;
             
-            JsonValue arr = JsonParser::parse(content);
+            LCHBOT::JsonValue arr = LCHBOT::MessagePack::looksLikeMessagePack(content)
+                ? LCHBOT::MessagePack::decode(content)
+                : LCHBOT::JsonParser::parse(content);
             if (arr.isArray()) {
                 for (const auto& item : arr.asArray()) {
                     if (item.isObject()) {
@@ -192,6 +211,7 @@ private:
     std::atomic<bool> running_;
     std::thread worker_thread_;
     std::string queue_file_;
+    LCHBOT::WireFormat format_ = LCHBOT::WireFormat::Json;
     SendCallback send_group_callback_;
     SendCallback send_private_callback_;
 };
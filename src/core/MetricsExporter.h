@@ -165,6 +165,13 @@ public:
             "lchbot_ai_latency_seconds", "AI request latency",
             std::vector<double>{0.1, 0.5, 1, 2, 5, 10, 30, 60});
         
+        ws_rtt_ = std::make_unique<Histogram>(
+            "lchbot_ws_rtt_seconds", "WebSocket ping round-trip time",
+            std::vector<double>{0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5});
+        
+        ws_reconnects_ = std::make_unique<Counter>(
+            "lchbot_ws_reconnect_attempts_total", "WebSocket reconnect attempts");
+        
         plugin_executions_ = std::make_unique<LabeledCounter>(
             "lchbot_plugin_executions_total", "Plugin execution count", std::vector<std::string>{"plugin", "status"});
         
@@ -195,6 +202,14 @@ public:
         ai_latency_->observe(latency_seconds);
     }
     
+    void recordWebSocketRtt(double rtt_seconds) {
+        ws_rtt_->observe(rtt_seconds);
+    }
+    
+    void recordReconnectAttempt() {
+        ws_reconnects_->inc();
+    }
+    
     void recordPluginExecution(const std::string& plugin, bool success) {
         plugin_executions_->inc({plugin, success ? "success" : "failure"});
     }
@@ -238,6 +253,8 @@ public:
         ss << formatLabeledCounter(*messages_total_);
         ss << formatLabeledCounter(*ai_requests_total_);
         ss << formatHistogram(*ai_latency_);
+        ss << formatHistogram(*ws_rtt_);
+        ss << formatCounter(*ws_reconnects_);
         ss << formatLabeledCounter(*plugin_executions_);
         ss << formatLabeledCounter(*rate_limited_);
         ss << formatLabeledCounter(*errors_total_);
@@ -290,6 +307,14 @@ private:
         return ss.str();
     }
     
+    std::string formatCounter(const Counter& counter) {
+        std::stringstream ss;
+        ss << "# HELP " << counter.getName() << " " << counter.getHelp() << "\n";
+        ss << "# TYPE " << counter.getName() << " counter\n";
+        ss << counter.getName() << " " << counter.get() << "\n\n";
+        return ss.str();
+    }
+    
     std::string formatLabeledCounter(const LabeledCounter& counter) {
         std::stringstream ss;
         ss << "# HELP " << counter.getName() << " " << counter.getHelp() << "\n";
@@ -330,6 +355,8 @@ private:
     std::unique_ptr<LabeledCounter> messages_total_;
     std::unique_ptr<LabeledCounter> ai_requests_total_;
     std::unique_ptr<Histogram> ai_latency_;
+    std::unique_ptr<Histogram> ws_rtt_;
+    std::unique_ptr<Counter> ws_reconnects_;
     std::unique_ptr<LabeledCounter> plugin_executions_;
     std::unique_ptr<Gauge> active_connections_;
     std::unique_ptr<Gauge> memory_usage_;
@@ -14,6 +14,7 @@
 #include <atomic>
 #include <functional>
 #include <filesystem>
+#include "TextEscape.h"
 
 namespace LCHBOT {
 
@@ -296,18 +297,7 @@ private:
     }
     
     std::string escapeJson(const std::string& str) const {
-        std::string result;
-        for (char c : str) {
-            switch (c) {
-                case '"': result += "\\\""; break;
-                case '\\': result += "\\\\"; break;
-                case '\n': result += "\\n"; break;
-                case '\r': result += "\\r"; break;
-                case '\t': result += "\\t"; break;
-                default: result += c; break;
-            }
-        }
-        return result;
+        return TextEscape::json(str);
     }
     
     void writeToFile(const std::string& json) {
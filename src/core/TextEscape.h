@@ -0,0 +1,213 @@
+#pragma once
+
+#include "JsonStructuralIndex.h"
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCHBOT {
+
+enum class EscapeStyle {
+    Json,
+    Python
+};
+
+class TextEscape {
+public:
+    static void append(std::string& out, std::string_view s, EscapeStyle style = EscapeStyle::Json, char quote = '"') {
+        size_t mark = out.size();
+        if (appendEscaped(out, s, style, quote) && !isValidUtf8(s)) {
+            out.resize(mark);
+            appendEscaped(out, sanitizeUtf8(s), style, quote);
+        }
+    }
+
+    static bool appendEscaped(std::string& out, std::string_view s, EscapeStyle style, char quote) {
+        static constexpr char hex[] = "0123456789abcdef";
+        const char* p = s.data();
+        const char* end = p + s.size();
+        bool vector_non_ascii = false;
+        while (p < end) {
+            const char* run = safePrefix(p, end, quote, vector_non_ascii);
+            out.append(p, run - p);
+            p = run;
+            if (p >= end) break;
+
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (c >= 0x80) {
+                const char* start = p;
+                while (p < end && static_cast<unsigned char>(*p) >= 0x80) {
+                    size_t len = vector_non_ascii ? 1 : utf8SequenceLength(p, end);
+                    if (len == 0) {
+                        out.append(start, p - start);
+                        out.append("\xEF\xBF\xBD");
+                        start = ++p;
+                    } else {
+                        p += len;
+                    }
+                }
+                out.append(start, p - start);
+                continue;
+            }
+
+            switch (c) {
+                case '\\': out.append("\\\\"); break;
+                case '\b': out.append("\\b"); break;
+                case '\f': out.append("\\f"); break;
+                case '\n': out.append("\\n"); break;
+                case '\r': out.append("\\r"); break;
+                case '\t': out.append("\\t"); break;
+                default:
+                    if (c == static_cast<unsigned char>(quote)) {
+                        out.push_back('\\');
+                        out.push_back(quote);
+                    } else if (style == EscapeStyle::Json) {
+                        char buf[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                        out.append(buf, sizeof(buf));
+                    } else {
+                        char buf[4] = {'\\', 'x', hex[c >> 4], hex[c & 0xF]};
+                        out.append(buf, sizeof(buf));
+                    }
+            }
+            ++p;
+        }
+        return vector_non_ascii;
+    }
+
+    static std::string sanitizeUtf8(std::string_view s) {
+        std::string out;
+        out.reserve(s.size() + 8);
+        const char* p = s.data();
+        const char* end = p + s.size();
+        while (p < end) {
+            const char* run = asciiPrefix(p, end);
+            out.append(p, run - p);
+            p = run;
+            if (p >= end) break;
+            size_t len = utf8SequenceLength(p, end);
+            if (len == 0) {
+                out.append("\xEF\xBF\xBD");
+                ++p;
+            } else {
+                out.append(p, len);
+                p += len;
+            }
+        }
+        return out;
+    }
+
+    static std::string json(std::string_view s) {
+        std::string out;
+        out.reserve(s.size() + 16);
+        append(out, s, EscapeStyle::Json);
+        return out;
+    }
+
+    static std::string pythonLiteral(std::string_view s, char quote = '"') {
+        std::string out;
+        out.reserve(s.size() + s.size() / 8 + 2);
+        out.push_back(quote);
+        append(out, s, EscapeStyle::Python, quote);
+        out.push_back(quote);
+        return out;
+    }
+
+    static bool isValidUtf8(std::string_view s) {
+        const char* p = s.data();
+        const char* end = p + s.size();
+        while (p < end) {
+            p = asciiPrefix(p, end);
+            while (p < end && static_cast<unsigned char>(*p) >= 0x80) {
+                size_t len = utf8SequenceLength(p, end);
+                if (len == 0) return false;
+                p += len;
+            }
+        }
+        return true;
+    }
+
+    static size_t utf8SequenceLength(const char* s, const char* end) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+        size_t avail = static_cast<size_t>(end - s);
+        unsigned char c = p[0];
+        if (c < 0x80) return 1;
+        if (c < 0xC2) return 0;
+        if (c < 0xE0) {
+            return (avail >= 2 && (p[1] & 0xC0) == 0x80) ? 2 : 0;
+        }
+        if (c < 0xF0) {
+            if (avail < 3 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80) return 0;
+            if (c == 0xE0 && p[1] < 0xA0) return 0;
+            if (c == 0xED && p[1] >= 0xA0) return 0;
+            return 3;
+        }
+        if (c < 0xF5) {
+            if (avail < 4 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80 || (p[3] & 0xC0) != 0x80) return 0;
+            if (c == 0xF0 && p[1] < 0x90) return 0;
+            if (c == 0xF4 && p[1] >= 0x90) return 0;
+            return 4;
+        }
+        return 0;
+    }
+
+    static const char* safePrefix(const char* p, const char* end, char quote, bool& non_ascii) {
+#if defined(LCHBOT_JSON_AVX2)
+        const __m256i q = _mm256_set1_epi8(quote);
+        const __m256i bs = _mm256_set1_epi8('\\');
+        const __m256i control = _mm256_set1_epi8(0x1F);
+        while (end - p >= 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            if (_mm256_movemask_epi8(v)) non_ascii = true;
+            __m256i special = _mm256_or_si256(
+                _mm256_cmpeq_epi8(_mm256_min_epu8(v, control), v),
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, q), _mm256_cmpeq_epi8(v, bs)));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+            if (mask) return p + JsonStructuralIndex::trailingZeros(mask);
+            p += 32;
+        }
+#elif defined(LCHBOT_JSON_SSE2)
+        const __m128i q = _mm_set1_epi8(quote);
+        const __m128i bs = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x1F);
+        while (end - p >= 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if (_mm_movemask_epi8(v)) non_ascii = true;
+            __m128i special = _mm_or_si128(
+                _mm_cmpeq_epi8(_mm_min_epu8(v, control), v),
+                _mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_cmpeq_epi8(v, bs)));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+            if (mask) return p + JsonStructuralIndex::trailingZeros(mask);
+            p += 16;
+        }
+#endif
+        while (p < end) {
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (c < 0x20 || c >= 0x80 || c == static_cast<unsigned char>(quote) || c == '\\') return p;
+            ++p;
+        }
+        return p;
+    }
+
+    static const char* asciiPrefix(const char* p, const char* end) {
+#if defined(LCHBOT_JSON_AVX2)
+        while (end - p >= 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+            if (mask) return p + JsonStructuralIndex::trailingZeros(mask);
+            p += 32;
+        }
+#elif defined(LCHBOT_JSON_SSE2)
+        while (end - p >= 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(v));
+            if (mask) return p + JsonStructuralIndex::trailingZeros(mask);
+            p += 16;
+        }
+#endif
+        while (p < end && static_cast<unsigned char>(*p) < 0x80) ++p;
+        return p;
+    }
+};
+
+}
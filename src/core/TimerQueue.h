@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include "Logger.h"
+
+namespace LCHBOT {
+
+class TimerQueue {
+public:
+    using Task = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    static TimerQueue& instance() {
+        static TimerQueue queue;
+        return queue;
+    }
+
+    TimerQueue() : running_(true), thread_(&TimerQueue::run, this) {}
+
+    ~TimerQueue() { stop(); }
+
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator=(const TimerQueue&) = delete;
+
+    uint64_t schedule(std::chrono::milliseconds delay, Task task) {
+        uint64_t id;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) return 0;
+            id = ++next_id_;
+            timers_.emplace(std::make_pair(Clock::now() + delay, id), std::move(task));
+        }
+        cv_.notify_one();
+        return id;
+    }
+
+    bool cancel(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(timers_.begin(), timers_.end(), [id](const auto& entry) { return entry.first.second == id; });
+        if (it == timers_.end()) return false;
+        timers_.erase(it);
+        return true;
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timers_.size();
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) return;
+            running_ = false;
+            timers_.clear();
+        }
+        cv_.notify_all();
+        if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+            thread_.join();
+        }
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            if (timers_.empty()) {
+                cv_.wait(lock);
+                continue;
+            }
+            auto due = timers_.begin()->first.first;
+            if (Clock::now() < due) {
+                cv_.wait_until(lock, due);
+                continue;
+            }
+            Task task = std::move(timers_.begin()->second);
+            timers_.erase(timers_.begin());
+            lock.unlock();
+            try {
+                task();
+            } catch (const std::exception& e) {
+                LOG_ERROR("[TimerQueue] Task failed: " + std::string(e.what()));
+            }
+            lock.lock();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<std::pair<Clock::time_point, uint64_t>, Task> timers_;
+    uint64_t next_id_ = 0;
+    bool running_;
+    std::thread thread_;
+};
+
+class Backoff {
+public:
+    Backoff(std::chrono::milliseconds base, std::chrono::milliseconds cap)
+        : base_(std::max<int64_t>(1, base.count())), cap_(std::max(base_, static_cast<int64_t>(cap.count()))),
+          rng_(std::random_device{}()) {}
+
+    std::chrono::milliseconds next() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int64_t ceiling = base_;
+        for (uint32_t i = 0; i < attempts_ && ceiling < cap_; ++i) ceiling *= 2;
+        ceiling = std::min(ceiling, cap_);
+        ++attempts_;
+        std::uniform_int_distribution<int64_t> jitter(0, ceiling / 2);
+        return std::chrono::milliseconds(ceiling - ceiling / 2 + jitter(rng_));
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        attempts_ = 0;
+    }
+
+    uint32_t attempts() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return attempts_;
+    }
+
+private:
+    int64_t base_;
+    int64_t cap_;
+    uint32_t attempts_ = 0;
+    std::mt19937_64 rng_;
+    mutable std::mutex mutex_;
+};
+
+}
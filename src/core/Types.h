@@ -1,14 +1,20 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <memory_resource>
 #include <variant>
 #include <optional>
 #include <cstdint>
 #include <memory>
 #include <functional>
 #include <chrono>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include "KeyAtoms.h"
 
 namespace LCHBOT {
 
@@ -22,6 +28,205 @@ using Json = std::map<std::string, std::variant<
     std::map<std::string, struct JsonValue>
 >>;
 
+template <typename V>
+class BasicJsonObject {
+public:
+    using key_type = JsonKey;
+    using mapped_type = V;
+    using value_type = std::pair<JsonKey, V>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+    
+    static constexpr size_t kIndexThreshold = 16;
+    
+    BasicJsonObject() = default;
+    
+    BasicJsonObject(std::initializer_list<value_type> init) {
+        reserve(init.size());
+        for (const auto& [k, v] : init) {
+            insert_or_assign(k, v);
+        }
+    }
+    
+    template <typename Compare, typename Alloc>
+    BasicJsonObject(const std::map<std::string, V, Compare, Alloc>& m) {
+        reserve(m.size());
+        for (const auto& [k, v] : m) {
+            entries_.emplace_back(k, v);
+        }
+        if (entries_.size() > kIndexThreshold) rebuildIndex();
+    }
+    
+    iterator begin() { return entries_.begin(); }
+    iterator end() { return entries_.end(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+    
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    
+    void reserve(size_t n) { entries_.reserve(n); }
+    
+    void clear() {
+        entries_.clear();
+        slots_.clear();
+    }
+    
+    iterator find(std::string_view key) {
+        size_t i = indexOf(key);
+        return i == npos ? entries_.end() : entries_.begin() + i;
+    }
+    
+    const_iterator find(std::string_view key) const {
+        size_t i = indexOf(key);
+        return i == npos ? entries_.end() : entries_.begin() + i;
+    }
+    
+    iterator find(Key key) {
+        size_t i = indexOf(key);
+        return i == npos ? entries_.end() : entries_.begin() + i;
+    }
+    
+    const_iterator find(Key key) const {
+        size_t i = indexOf(key);
+        return i == npos ? entries_.end() : entries_.begin() + i;
+    }
+    
+    size_t count(std::string_view key) const { return indexOf(key) == npos ? 0 : 1; }
+    bool contains(std::string_view key) const { return indexOf(key) != npos; }
+    bool contains(Key key) const { return indexOf(key) != npos; }
+    
+    V& at(std::string_view key) {
+        size_t i = indexOf(key);
+        if (i == npos) throw std::out_of_range("JsonObject key not found: " + std::string(key));
+        return entries_[i].second;
+    }
+    
+    const V& at(std::string_view key) const {
+        size_t i = indexOf(key);
+        if (i == npos) throw std::out_of_range("JsonObject key not found: " + std::string(key));
+        return entries_[i].second;
+    }
+    
+    const V& at(Key key) const {
+        size_t i = indexOf(key);
+        if (i == npos) throw std::out_of_range("JsonObject key not found: " + std::string(KeyTable::name(key)));
+        return entries_[i].second;
+    }
+    
+    V& operator[](std::string_view key) {
+        size_t i = indexOf(key);
+        if (i != npos) return entries_[i].second;
+        return append(JsonKey(key), V()).second;
+    }
+    
+    std::pair<iterator, bool> emplace(JsonKey key, V value) {
+        size_t i = indexOf(key);
+        if (i != npos) return {entries_.begin() + i, false};
+        append(std::move(key), std::move(value));
+        return {entries_.end() - 1, true};
+    }
+    
+    std::pair<iterator, bool> insert_or_assign(JsonKey key, V value) {
+        size_t i = indexOf(key);
+        if (i != npos) {
+            entries_[i].second = std::move(value);
+            return {entries_.begin() + i, false};
+        }
+        append(std::move(key), std::move(value));
+        return {entries_.end() - 1, true};
+    }
+    
+    size_t erase(std::string_view key) {
+        size_t i = indexOf(key);
+        if (i == npos) return 0;
+        entries_.erase(entries_.begin() + i);
+        if (!slots_.empty()) rebuildIndex();
+        return 1;
+    }
+    
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    
+    static size_t hashKey(std::string_view key) {
+        return std::hash<std::string_view>{}(key);
+    }
+    
+    size_t indexOf(const JsonKey& key) const {
+        return key.interned() ? indexOf(key.atom()) : indexOf(key.view());
+    }
+    
+    size_t indexOf(Key key) const {
+        if (slots_.empty()) {
+            for (size_t i = 0; i < entries_.size(); ++i) {
+                if (entries_[i].first == key) return i;
+            }
+            return npos;
+        }
+        size_t mask = slots_.size() - 1;
+        for (size_t slot = hashKey(KeyTable::name(key)) & mask; slots_[slot] != 0; slot = (slot + 1) & mask) {
+            size_t i = slots_[slot] - 1;
+            if (entries_[i].first == key) return i;
+        }
+        return npos;
+    }
+    
+    size_t indexOf(std::string_view key) const {
+        Key atom = KeyTable::lookup(key);
+        if (atom != Key::None) return indexOf(atom);
+        if (slots_.empty()) {
+            for (size_t i = 0; i < entries_.size(); ++i) {
+                if (entries_[i].first == key) return i;
+            }
+            return npos;
+        }
+        size_t mask = slots_.size() - 1;
+        for (size_t slot = hashKey(key) & mask; slots_[slot] != 0; slot = (slot + 1) & mask) {
+            size_t i = slots_[slot] - 1;
+            if (entries_[i].first == key) return i;
+        }
+        return npos;
+    }
+    
+    value_type& append(JsonKey key, V value) {
+        entries_.emplace_back(std::move(key), std::move(value));
+        if (!slots_.empty() && entries_.size() * 2 <= slots_.size()) {
+            insertSlot(entries_.size() - 1);
+        } else if (entries_.size() > kIndexThreshold) {
+            rebuildIndex();
+        }
+        return entries_.back();
+    }
+    
+    void insertSlot(size_t i) {
+        size_t mask = slots_.size() - 1;
+        size_t slot = hashKey(entries_[i].first.view()) & mask;
+        while (slots_[slot] != 0) slot = (slot + 1) & mask;
+        slots_[slot] = static_cast<uint32_t>(i + 1);
+    }
+    
+    void rebuildIndex() {
+        slots_.clear();
+        if (entries_.size() <= kIndexThreshold) return;
+        size_t capacity = 64;
+        while (capacity < entries_.size() * 4) capacity <<= 1;
+        slots_.assign(capacity, 0);
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            insertSlot(i);
+        }
+    }
+    
+    std::vector<value_type> entries_;
+    std::vector<uint32_t> slots_;
+};
+
+struct JsonValue;
+using JsonObject = BasicJsonObject<JsonValue>;
+
+struct JsonBigNumber {
+    std::string text;
+};
+
 struct JsonValue {
     std::variant<
         std::nullptr_t,
@@ -30,7 +235,8 @@ struct JsonValue {
         double,
         std::string,
         std::vector<JsonValue>,
-        std::map<std::string, JsonValue>
+        JsonObject,
+        JsonBigNumber
     > value;
     
     JsonValue() : value(nullptr) {}
@@ -40,9 +246,12 @@ struct JsonValue {
     JsonValue(int64_t v) : value(v) {}
     JsonValue(double v) : value(v) {}
     JsonValue(const std::string& v) : value(v) {}
+    JsonValue(std::string_view v) : value(std::string(v)) {}
     JsonValue(const char* v) : value(std::string(v)) {}
     JsonValue(std::vector<JsonValue> v) : value(std::move(v)) {}
-    JsonValue(std::map<std::string, JsonValue> v) : value(std::move(v)) {}
+    JsonValue(JsonObject v) : value(std::move(v)) {}
+    JsonValue(JsonBigNumber v) : value(std::move(v)) {}
+    JsonValue(const std::map<std::string, JsonValue>& v) : value(JsonObject(v)) {}
     
     bool isNull() const { return std::holds_alternative<std::nullptr_t>(value); }
     bool isBool() const { return std::holds_alternative<bool>(value); }
@@ -50,7 +259,8 @@ struct JsonValue {
     bool isDouble() const { return std::holds_alternative<double>(value); }
     bool isString() const { return std::holds_alternative<std::string>(value); }
     bool isArray() const { return std::holds_alternative<std::vector<JsonValue>>(value); }
-    bool isObject() const { return std::holds_alternative<std::map<std::string, JsonValue>>(value); }
+    bool isObject() const { return std::holds_alternative<JsonObject>(value); }
+    bool isBigNumber() const { return std::holds_alternative<JsonBigNumber>(value); }
     
     bool asBool() const { return std::get<bool>(value); }
     int64_t asInt() const { return std::get<int64_t>(value); }
@@ -58,21 +268,20 @@ struct JsonValue {
     const std::string& asString() const { return std::get<std::string>(value); }
     std::vector<JsonValue>& asArray() { return std::get<std::vector<JsonValue>>(value); }
     const std::vector<JsonValue>& asArray() const { return std::get<std::vector<JsonValue>>(value); }
-    std::map<std::string, JsonValue>& asObject() { return std::get<std::map<std::string, JsonValue>>(value); }
-    const std::map<std::string, JsonValue>& asObject() const { return std::get<std::map<std::string, JsonValue>>(value); }
+    JsonObject& asObject() { return std::get<JsonObject>(value); }
+    const JsonObject& asObject() const { return std::get<JsonObject>(value); }
+    const JsonBigNumber& asBigNumber() const { return std::get<JsonBigNumber>(value); }
     
-    JsonValue& operator[](const std::string& key) {
-        return std::get<std::map<std::string, JsonValue>>(value)[key];
+    JsonValue& operator[](std::string_view key) {
+        return std::get<JsonObject>(value)[key];
     }
     
     JsonValue& operator[](size_t index) {
         return std::get<std::vector<JsonValue>>(value)[index];
     }
     
-    bool contains(const std::string& key) const {
-        if (!isObject()) return false;
-        const auto& obj = asObject();
-        return obj.find(key) != obj.end();
+    bool contains(std::string_view key) const {
+        return isObject() && asObject().contains(key);
     }
 };
 
@@ -115,8 +324,17 @@ enum class MetaEventType {
 };
 
 struct MessageSegment {
-    std::string type;
-    std::map<std::string, std::string> data;
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+    
+    std::pmr::string type;
+    std::pmr::map<JsonKey, std::pmr::string, JsonKeyLess> data;
+    
+    MessageSegment() = default;
+    explicit MessageSegment(allocator_type alloc) : type(alloc), data(alloc) {}
+    MessageSegment(const MessageSegment&) = default;
+    MessageSegment(MessageSegment&&) = default;
+    MessageSegment& operator=(const MessageSegment&) = default;
+    MessageSegment& operator=(MessageSegment&&) = default;
 };
 
 struct Sender {
@@ -0,0 +1,338 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Config.h"
+#include "Logger.h"
+
+namespace LCHBOT {
+
+enum class OverflowPolicy {
+    Block,
+    Reject,
+    DropOldest,
+    CallerRuns
+};
+
+class WorkerPool {
+public:
+    using Task = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::array<double, 8> kWaitBuckets = {0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 5};
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t dequeued = 0;
+        uint64_t completed = 0;
+        uint64_t rejected = 0;
+        uint64_t deferred = 0;
+        uint64_t dropped = 0;
+        uint64_t caller_runs = 0;
+        size_t depth = 0;
+        size_t max_depth = 0;
+        size_t capacity = 0;
+        size_t threads = 0;
+        double wait_seconds = 0;
+        std::array<uint64_t, kWaitBuckets.size()> wait_buckets{};
+    };
+
+    static WorkerPool& instance() {
+        static WorkerPool pool(ConfigManager::instance().config().worker.threads,
+                               ConfigManager::instance().config().worker.queue_capacity,
+                               parsePolicy(ConfigManager::instance().config().worker.overflow_policy));
+        return pool;
+    }
+
+    static OverflowPolicy parsePolicy(const std::string& name) {
+        if (name == "reject") return OverflowPolicy::Reject;
+        if (name == "drop_oldest") return OverflowPolicy::DropOldest;
+        if (name == "caller_runs") return OverflowPolicy::CallerRuns;
+        return OverflowPolicy::Block;
+    }
+
+    explicit WorkerPool(size_t threads = 0, size_t capacity = 0, OverflowPolicy policy = OverflowPolicy::Block)
+        : capacity_(capacity), policy_(policy) {
+        if (threads == 0) {
+            threads = std::max<size_t>(4, std::thread::hardware_concurrency());
+        }
+        running_ = true;
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back(&WorkerPool::workerLoop, this);
+        }
+    }
+
+    ~WorkerPool() { stop(); }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    bool submit(Task task) { return admit(std::move(task), true); }
+
+    bool trySubmit(Task task) { return admit(std::move(task), false); }
+
+    bool post(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) return false;
+            enqueue(std::move(task));
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) return;
+            running_ = false;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+        for (auto& worker : workers_) {
+            if (worker.joinable()) worker.join();
+        }
+        workers_.clear();
+    }
+
+    size_t threads() const { return workers_.size(); }
+
+    bool appliesBackpressure() const {
+        return policy_ == OverflowPolicy::Block || policy_ == OverflowPolicy::CallerRuns;
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tasks_.size();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats s;
+        s.submitted = submitted_;
+        s.dequeued = dequeued_;
+        s.completed = completed_;
+        s.rejected = rejected_;
+        s.deferred = deferred_;
+        s.dropped = dropped_;
+        s.caller_runs = caller_runs_;
+        s.depth = tasks_.size();
+        s.max_depth = max_depth_;
+        s.capacity = capacity_;
+        s.threads = workers_.size();
+        s.wait_seconds = wait_seconds_;
+        s.wait_buckets = wait_buckets_;
+        return s;
+    }
+
+    std::string exportPrometheus(const std::string& name = "worker") const {
+        Stats s = stats();
+        std::ostringstream ss;
+        std::string prefix = "lchbot_" + name + "_";
+        ss << "# HELP " << prefix << "queue_depth Tasks waiting in the worker queue\n";
+        ss << "# TYPE " << prefix << "queue_depth gauge\n";
+        ss << prefix << "queue_depth " << s.depth << "\n\n";
+        ss << "# HELP " << prefix << "queue_max_depth Highest observed worker queue depth\n";
+        ss << "# TYPE " << prefix << "queue_max_depth gauge\n";
+        ss << prefix << "queue_max_depth " << s.max_depth << "\n\n";
+        ss << "# HELP " << prefix << "tasks_total Worker tasks by outcome\n";
+        ss << "# TYPE " << prefix << "tasks_total counter\n";
+        ss << prefix << "tasks_total{outcome=\"submitted\"} " << s.submitted << "\n";
+        ss << prefix << "tasks_total{outcome=\"completed\"} " << s.completed << "\n";
+        ss << prefix << "tasks_total{outcome=\"rejected\"} " << s.rejected << "\n";
+        ss << prefix << "tasks_total{outcome=\"deferred\"} " << s.deferred << "\n";
+        ss << prefix << "tasks_total{outcome=\"dropped\"} " << s.dropped << "\n";
+        ss << prefix << "tasks_total{outcome=\"caller_runs\"} " << s.caller_runs << "\n\n";
+        ss << "# HELP " << prefix << "wait_seconds Time tasks spent queued before a worker picked them up\n";
+        ss << "# TYPE " << prefix << "wait_seconds histogram\n";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < kWaitBuckets.size(); ++i) {
+            cumulative += s.wait_buckets[i];
+            ss << prefix << "wait_seconds_bucket{le=\"" << kWaitBuckets[i] << "\"} " << cumulative << "\n";
+        }
+        ss << prefix << "wait_seconds_bucket{le=\"+Inf\"} " << s.dequeued << "\n";
+        ss << prefix << "wait_seconds_sum " << s.wait_seconds << "\n";
+        ss << prefix << "wait_seconds_count " << s.dequeued << "\n\n";
+        return ss.str();
+    }
+
+    static void runTask(const Task& task) {
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOG_ERROR("[WorkerPool] Task failed: " + std::string(e.what()));
+        } catch (...) {
+            LOG_ERROR("[WorkerPool] Task failed with unknown exception");
+        }
+    }
+
+private:
+    bool admit(Task task, bool may_wait) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!running_) return false;
+
+        if (capacity_ > 0 && tasks_.size() >= capacity_) {
+            switch (policy_) {
+            case OverflowPolicy::Block:
+                if (!may_wait) {
+                    ++deferred_;
+                    return false;
+                }
+                not_full_.wait(lock, [this] { return !running_ || tasks_.size() < capacity_; });
+                if (!running_) return false;
+                break;
+            case OverflowPolicy::Reject:
+                ++rejected_;
+                return false;
+            case OverflowPolicy::DropOldest:
+                tasks_.pop_front();
+                ++dropped_;
+                break;
+            case OverflowPolicy::CallerRuns:
+                if (!may_wait) {
+                    ++deferred_;
+                    return false;
+                }
+                ++caller_runs_;
+                lock.unlock();
+                runTask(task);
+                return true;
+            }
+        }
+
+        enqueue(std::move(task));
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    struct Entry {
+        Task task;
+        Clock::time_point enqueued;
+    };
+
+    void enqueue(Task task) {
+        tasks_.push_back({std::move(task), Clock::now()});
+        ++submitted_;
+        max_depth_ = std::max(max_depth_, tasks_.size());
+    }
+
+    void recordWait(double seconds) {
+        ++dequeued_;
+        wait_seconds_ += seconds;
+        for (size_t i = 0; i < kWaitBuckets.size(); ++i) {
+            if (seconds <= kWaitBuckets[i]) {
+                ++wait_buckets_[i];
+                break;
+            }
+        }
+    }
+
+    void workerLoop() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                not_empty_.wait(lock, [this] { return !running_ || !tasks_.empty(); });
+                if (tasks_.empty()) return;
+                Entry entry = std::move(tasks_.front());
+                tasks_.pop_front();
+                recordWait(std::chrono::duration<double>(Clock::now() - entry.enqueued).count());
+                task = std::move(entry.task);
+            }
+            not_full_.notify_one();
+            runTask(task);
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++completed_;
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<Entry> tasks_;
+    std::vector<std::thread> workers_;
+    bool running_ = false;
+    size_t capacity_;
+    OverflowPolicy policy_;
+
+    uint64_t submitted_ = 0;
+    uint64_t dequeued_ = 0;
+    uint64_t completed_ = 0;
+    uint64_t rejected_ = 0;
+    uint64_t deferred_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t caller_runs_ = 0;
+    size_t max_depth_ = 0;
+    double wait_seconds_ = 0;
+    std::array<uint64_t, kWaitBuckets.size()> wait_buckets_{};
+};
+
+class Strand : public std::enable_shared_from_this<Strand> {
+public:
+    using Task = WorkerPool::Task;
+
+    static constexpr size_t kBatch = 64;
+
+    explicit Strand(WorkerPool& pool) : pool_(pool) {}
+
+    void post(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+            if (scheduled_) return;
+            scheduled_ = true;
+        }
+        schedule();
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tasks_.size();
+    }
+
+private:
+    void schedule() {
+        if (!pool_.post([self = shared_from_this()] { self->drain(); })) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.clear();
+            scheduled_ = false;
+        }
+    }
+
+    void drain() {
+        for (size_t n = 0; n < kBatch; ++n) {
+            Task task;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (tasks_.empty()) {
+                    scheduled_ = false;
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            WorkerPool::runTask(task);
+        }
+        schedule();
+    }
+
+    WorkerPool& pool_;
+    mutable std::mutex mutex_;
+    std::deque<Task> tasks_;
+    bool scheduled_ = false;
+};
+
+}
@@ -1,5 +1,6 @@
 #include "bot/Bot.h"
 #include "core/Logger.h"
+#include "core/FrameArena.h"
 #include <iostream>
 #include <csignal>
 
@@ -7,6 +8,10 @@
 #include <windows.h>
 #endif
 
+#ifdef LCHBOT_COUNT_ALLOCATIONS
+LCHBOT_DEFINE_ALLOCATION_HOOKS()
+#endif
+
 namespace {
     std::atomic<bool> g_running{true};
 }
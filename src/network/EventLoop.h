@@ -0,0 +1,379 @@
+#pragma once
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define _WINSOCK_DEPRECATED_NO_WARNINGS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#define SOCKET int
+#define INVALID_SOCKET -1
+#define SOCKET_ERROR -1
+#define closesocket close
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../core/Logger.h"
+
+namespace LCHBOT {
+
+class EventLoop {
+public:
+    enum : uint32_t {
+        Readable = 1,
+        Writable = 2,
+        Closed = 4
+    };
+
+    using Handler = std::function<void(uint32_t)>;
+    using Task = std::function<void()>;
+
+#ifdef _WIN32
+    static constexpr int kSendFlags = 0;
+#else
+    static constexpr int kSendFlags = MSG_NOSIGNAL;
+#endif
+
+    EventLoop() {
+#ifdef _WIN32
+        WSADATA wsa_data;
+        WSAStartup(MAKEWORD(2, 2), &wsa_data);
+        wake_socket_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        socklen_t addr_len = sizeof(addr);
+        if (wake_socket_ == INVALID_SOCKET ||
+            bind(wake_socket_, (sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR ||
+            getsockname(wake_socket_, (sockaddr*)&addr, &addr_len) == SOCKET_ERROR ||
+            ::connect(wake_socket_, (sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR) {
+            throw std::runtime_error("Failed to create event loop wakeup socket");
+        }
+        setNonBlocking(wake_socket_);
+#else
+        poll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (poll_fd_ < 0 || wake_fd_ < 0) {
+            throw std::runtime_error("Failed to create event loop");
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = wake_fd_;
+        epoll_ctl(poll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+#endif
+    }
+
+    ~EventLoop() {
+        stop();
+#ifdef _WIN32
+        closesocket(wake_socket_);
+        WSACleanup();
+#else
+        close(wake_fd_);
+        close(poll_fd_);
+#endif
+    }
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    void start() {
+        if (running_.exchange(true)) return;
+        thread_ = std::thread(&EventLoop::run, this);
+    }
+
+    void stop() {
+        if (!running_.exchange(false)) return;
+        wakeup();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    bool isRunning() const { return running_; }
+    bool inLoopThread() const { return std::this_thread::get_id() == loop_thread_id_.load(); }
+    size_t size() const { return registered_.load(std::memory_order_relaxed); }
+
+    void post(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(tasks_mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        wakeup();
+    }
+
+    void dispatch(Task task) {
+        if (inLoopThread()) {
+            task();
+        } else {
+            post(std::move(task));
+        }
+    }
+
+    void runSync(Task task) {
+        if (inLoopThread() || !running_) {
+            task();
+            return;
+        }
+        auto done = std::make_shared<std::promise<void>>();
+        std::future<void> finished = done->get_future();
+        post([task = std::move(task), done] {
+            task();
+            done->set_value();
+        });
+        finished.wait();
+    }
+
+    void add(SOCKET fd, uint32_t interest, Handler handler) {
+        registered_.fetch_add(1, std::memory_order_relaxed);
+        auto shared = std::make_shared<Handler>(std::move(handler));
+        dispatch([this, fd, interest, shared] {
+            handlers_[fd] = Entry{interest, shared};
+#ifndef _WIN32
+            epoll_event ev = toEpoll(fd, interest);
+            epoll_ctl(poll_fd_, EPOLL_CTL_ADD, fd, &ev);
+#endif
+        });
+    }
+
+    void modify(SOCKET fd, uint32_t interest) {
+        dispatch([this, fd, interest] {
+            auto it = handlers_.find(fd);
+            if (it == handlers_.end() || it->second.interest == interest) return;
+            it->second.interest = interest;
+#ifndef _WIN32
+            epoll_event ev = toEpoll(fd, interest);
+            epoll_ctl(poll_fd_, EPOLL_CTL_MOD, fd, &ev);
+#endif
+        });
+    }
+
+    void remove(SOCKET fd) {
+        dispatch([this, fd] {
+            if (handlers_.erase(fd) == 0) return;
+            registered_.fetch_sub(1, std::memory_order_relaxed);
+#ifndef _WIN32
+            epoll_ctl(poll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+#endif
+        });
+    }
+
+    static void setNonBlocking(SOCKET fd) {
+#ifdef _WIN32
+        u_long mode = 1;
+        ioctlsocket(fd, FIONBIO, &mode);
+#else
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+#endif
+    }
+
+    static bool wouldBlock() {
+#ifdef _WIN32
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+    }
+
+private:
+    struct Entry {
+        uint32_t interest = 0;
+        std::shared_ptr<Handler> handler;
+    };
+
+#ifndef _WIN32
+    static epoll_event toEpoll(SOCKET fd, uint32_t interest) {
+        epoll_event ev{};
+        ev.data.fd = fd;
+        if (interest & Readable) ev.events |= EPOLLIN | EPOLLRDHUP;
+        if (interest & Writable) ev.events |= EPOLLOUT;
+        return ev;
+    }
+#endif
+
+    void wakeup() {
+#ifdef _WIN32
+        char byte = 0;
+        ::send(wake_socket_, &byte, 1, 0);
+#else
+        uint64_t one = 1;
+        ssize_t written = write(wake_fd_, &one, sizeof(one));
+        (void)written;
+#endif
+    }
+
+    void drainWakeup() {
+#ifdef _WIN32
+        char buffer[64];
+        while (recv(wake_socket_, buffer, sizeof(buffer), 0) > 0) {}
+#else
+        uint64_t value = 0;
+        ssize_t n = read(wake_fd_, &value, sizeof(value));
+        (void)n;
+#endif
+    }
+
+    void fire(SOCKET fd, uint32_t events) {
+        auto it = handlers_.find(fd);
+        if (it == handlers_.end()) return;
+        std::shared_ptr<Handler> handler = it->second.handler;
+        try {
+            (*handler)(events);
+        } catch (const std::exception& e) {
+            LOG_ERROR("[EventLoop] Handler failed: " + std::string(e.what()));
+        }
+    }
+
+    void runTasks() {
+        std::vector<Task> tasks;
+        {
+            std::lock_guard<std::mutex> lock(tasks_mutex_);
+            tasks.swap(tasks_);
+        }
+        for (auto& task : tasks) {
+            try {
+                task();
+            } catch (const std::exception& e) {
+                LOG_ERROR("[EventLoop] Task failed: " + std::string(e.what()));
+            }
+        }
+    }
+
+    void run() {
+        loop_thread_id_ = std::this_thread::get_id();
+#ifdef _WIN32
+        std::vector<WSAPOLLFD> fds;
+#else
+        std::vector<epoll_event> events(256);
+#endif
+        while (running_) {
+            runTasks();
+#ifdef _WIN32
+            fds.clear();
+            fds.push_back({wake_socket_, POLLRDNORM, 0});
+            for (const auto& [fd, entry] : handlers_) {
+                SHORT mask = 0;
+                if (entry.interest & Readable) mask |= POLLRDNORM;
+                if (entry.interest & Writable) mask |= POLLWRNORM;
+                fds.push_back({fd, mask, 0});
+            }
+            int n = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), -1);
+            if (n == SOCKET_ERROR) {
+                LOG_ERROR("[EventLoop] WSAPoll failed: " + std::to_string(WSAGetLastError()));
+                continue;
+            }
+            if (fds[0].revents) drainWakeup();
+            for (size_t i = 1; i < fds.size(); ++i) {
+                SHORT revents = fds[i].revents;
+                if (revents == 0) continue;
+                uint32_t ready = 0;
+                if (revents & POLLRDNORM) ready |= Readable;
+                if (revents & POLLWRNORM) ready |= Writable;
+                if (revents & (POLLERR | POLLHUP | POLLNVAL)) ready |= Closed;
+                fire(fds[i].fd, ready);
+            }
+#else
+            int n = epoll_wait(poll_fd_, events.data(), static_cast<int>(events.size()), -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                LOG_ERROR("[EventLoop] epoll_wait failed: " + std::to_string(errno));
+                break;
+            }
+            for (int i = 0; i < n; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == wake_fd_) {
+                    drainWakeup();
+                    continue;
+                }
+                uint32_t ready = 0;
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP)) ready |= Readable;
+                if (events[i].events & EPOLLOUT) ready |= Writable;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) ready |= Closed;
+                fire(fd, ready);
+            }
+#endif
+        }
+        runTasks();
+        loop_thread_id_ = std::thread::id();
+    }
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    std::atomic<std::thread::id> loop_thread_id_{};
+    std::atomic<size_t> registered_{0};
+
+    std::mutex tasks_mutex_;
+    std::vector<Task> tasks_;
+    std::unordered_map<SOCKET, Entry> handlers_;
+
+#ifdef _WIN32
+    SOCKET wake_socket_ = INVALID_SOCKET;
+#else
+    int poll_fd_ = -1;
+    int wake_fd_ = -1;
+#endif
+};
+
+class EventLoopGroup {
+public:
+    static EventLoopGroup& instance() {
+        static EventLoopGroup group;
+        return group;
+    }
+
+    explicit EventLoopGroup(size_t threads = 0) {
+        if (threads == 0) {
+            threads = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            loops_.push_back(std::make_unique<EventLoop>());
+        }
+    }
+
+    ~EventLoopGroup() { stop(); }
+
+    void start() {
+        for (auto& loop : loops_) loop->start();
+    }
+
+    void stop() {
+        for (auto& loop : loops_) loop->stop();
+    }
+
+    EventLoop& next() {
+        size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+        EventLoop* best = loops_[start % loops_.size()].get();
+        for (size_t i = 1; i < loops_.size(); ++i) {
+            EventLoop* candidate = loops_[(start + i) % loops_.size()].get();
+            if (candidate->size() < best->size()) best = candidate;
+        }
+        return *best;
+    }
+
+    size_t size() const { return loops_.size(); }
+    EventLoop& at(size_t index) { return *loops_[index]; }
+
+private:
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    std::atomic<size_t> next_{0};
+};
+
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "WebSocketMask.h"
+
+namespace LCHBOT {
+
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity = 64 * 1024) {
+        capacity_ = 1;
+        while (capacity_ < capacity) capacity_ <<= 1;
+        data_ = std::make_unique<char[]>(capacity_);
+    }
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return static_cast<size_t>(tail_ - head_); }
+    size_t space() const { return capacity_ - size(); }
+    bool empty() const { return head_ == tail_; }
+
+    std::pair<char*, size_t> writable() {
+        if (space() == 0) grow(capacity_ * 2);
+        size_t start = index(tail_);
+        size_t limit = std::min(capacity_ - start, space());
+        return {data_.get() + start, limit};
+    }
+
+    void commit(size_t n) { tail_ += n; }
+
+    void append(const char* data, size_t len) {
+        while (len > 0) {
+            auto [ptr, room] = writable();
+            size_t n = std::min(room, len);
+            std::memcpy(ptr, data, n);
+            commit(n);
+            data += n;
+            len -= n;
+        }
+    }
+
+    char* contiguous(size_t offset, size_t& len) {
+        size_t start = index(head_ + offset);
+        len = std::min(len, capacity_ - start);
+        return data_.get() + start;
+    }
+
+    void copyOut(size_t offset, void* out, size_t len) const {
+        char* dst = static_cast<char*>(out);
+        size_t start = index(head_ + offset);
+        size_t first = std::min(len, capacity_ - start);
+        std::memcpy(dst, data_.get() + start, first);
+        std::memcpy(dst + first, data_.get(), len - first);
+    }
+
+    void consume(size_t n) {
+        head_ += n;
+        if (head_ == tail_) head_ = tail_ = 0;
+    }
+
+    void reserve(size_t capacity) {
+        if (capacity > capacity_) grow(capacity);
+    }
+
+    void clear() { head_ = tail_ = 0; }
+
+private:
+    size_t index(uint64_t position) const { return static_cast<size_t>(position & (capacity_ - 1)); }
+
+    void grow(size_t capacity) {
+        size_t grown = capacity_;
+        while (grown < capacity) grown <<= 1;
+        auto data = std::make_unique<char[]>(grown);
+        size_t n = size();
+        copyOut(0, data.get(), n);
+        data_ = std::move(data);
+        capacity_ = grown;
+        head_ = 0;
+        tail_ = n;
+    }
+
+    std::unique_ptr<char[]> data_;
+    size_t capacity_ = 0;
+    uint64_t head_ = 0;
+    uint64_t tail_ = 0;
+};
+
+struct FrameHeader {
+    bool fin = false;
+    bool rsv1 = false;
+    bool masked = false;
+    uint8_t opcode = 0;
+    uint8_t mask[4] = {0};
+    uint64_t length = 0;
+};
+
+struct FrameChunk {
+    const FrameHeader* header = nullptr;
+    std::string_view data;
+    bool begin = false;
+    bool end = false;
+
+    bool whole() const { return begin && end; }
+};
+
+class FrameDecoder {
+public:
+    static constexpr size_t kMaxHeader = 14;
+
+    explicit FrameDecoder(size_t capacity = 64 * 1024) : ring_(capacity) {}
+
+    std::pair<char*, size_t> writable() {
+        release();
+        return ring_.writable();
+    }
+
+    void commit(size_t n) { ring_.commit(n); }
+
+    void append(const char* data, size_t len) {
+        release();
+        ring_.append(data, len);
+    }
+
+    bool next(FrameChunk& chunk) {
+        release();
+
+        if (!active_) {
+            if (!parseHeader()) return false;
+            active_ = true;
+            position_ = 0;
+            remaining_ = header_.length;
+            if (remaining_ == 0) {
+                active_ = false;
+                chunk = FrameChunk{&header_, std::string_view(), true, true};
+                return true;
+            }
+        }
+
+        size_t buffered = ring_.size();
+        if (buffered == 0) return false;
+
+        bool wait_whole = position_ == 0 && header_.length <= ring_.capacity() / 2;
+        if (wait_whole && buffered < remaining_) return false;
+
+        size_t len = static_cast<size_t>(std::min<uint64_t>(remaining_, buffered));
+        char* data = ring_.contiguous(0, len);
+        if (header_.masked) WebSocketMask::apply(data, len, header_.mask, position_);
+
+        chunk.header = &header_;
+        chunk.data = std::string_view(data, len);
+        chunk.begin = position_ == 0;
+        position_ += len;
+        remaining_ -= len;
+        chunk.end = remaining_ == 0;
+        if (chunk.end) active_ = false;
+        held_ = len;
+        return true;
+    }
+
+    void reset() {
+        ring_.clear();
+        active_ = false;
+        held_ = 0;
+        position_ = 0;
+        remaining_ = 0;
+    }
+
+    bool inFrame() const { return active_; }
+    const FrameHeader& header() const { return header_; }
+    size_t buffered() const { return ring_.size(); }
+    size_t capacity() const { return ring_.capacity(); }
+
+private:
+    void release() {
+        if (held_ > 0) {
+            ring_.consume(held_);
+            held_ = 0;
+        }
+    }
+
+    bool parseHeader() {
+        size_t available = std::min(ring_.size(), kMaxHeader);
+        if (available < 2) return false;
+
+        uint8_t bytes[kMaxHeader];
+        ring_.copyOut(0, bytes, available);
+
+        FrameHeader header;
+        header.fin = (bytes[0] & 0x80) != 0;
+        header.rsv1 = (bytes[0] & 0x40) != 0;
+        header.opcode = bytes[0] & 0x0F;
+        header.masked = (bytes[1] & 0x80) != 0;
+        uint64_t payload_len = bytes[1] & 0x7F;
+        size_t offset = 2;
+
+        if (payload_len == 126) {
+            if (available < 4) return false;
+            payload_len = (static_cast<uint64_t>(bytes[2]) << 8) | bytes[3];
+            offset = 4;
+        } else if (payload_len == 127) {
+            if (available < 10) return false;
+            payload_len = 0;
+            for (int i = 0; i < 8; ++i) {
+                payload_len = (payload_len << 8) | bytes[2 + i];
+            }
+            offset = 10;
+        }
+
+        if (header.masked) {
+            if (available < offset + 4) return false;
+            std::memcpy(header.mask, bytes + offset, 4);
+            offset += 4;
+        }
+
+        header.length = payload_len;
+        header_ = header;
+        ring_.consume(offset);
+        return true;
+    }
+
+    RingBuffer ring_;
+    FrameHeader header_;
+    bool active_ = false;
+    size_t held_ = 0;
+    uint64_t position_ = 0;
+    uint64_t remaining_ = 0;
+};
+
+}
@@ -0,0 +1,466 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if __has_include(<zlib.h>)
+#include <zlib.h>
+#define LCHBOT_HAS_ZLIB 1
+#ifdef _WIN32
+#pragma comment(lib, "zlib.lib")
+#endif
+#endif
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+namespace LCHBOT {
+
+struct DeflateOptions {
+    bool enabled = false;
+    int window_bits = 15;
+    size_t min_size = 1024;
+    bool context_takeover = true;
+    int level = 6;
+};
+
+struct DeflateParams {
+    int deflate_window_bits = 15;
+    bool deflate_reset = false;
+    bool inflate_reset = false;
+};
+
+class DeflateStats {
+public:
+    static DeflateStats& instance() {
+        static DeflateStats stats;
+        return stats;
+    }
+
+    static double threadCpuSeconds() {
+#ifdef _WIN32
+        FILETIME created, exited, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+        uint64_t ticks = (static_cast<uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+        ticks += (static_cast<uint64_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+        return static_cast<double>(ticks) / 1e7;
+#else
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+#endif
+    }
+
+    void recordDeflate(size_t raw, size_t compressed, double cpu_seconds) {
+        deflated_messages_.fetch_add(1, std::memory_order_relaxed);
+        deflate_raw_.fetch_add(raw, std::memory_order_relaxed);
+        deflate_compressed_.fetch_add(compressed, std::memory_order_relaxed);
+        deflate_cpu_ns_.fetch_add(static_cast<uint64_t>(cpu_seconds * 1e9), std::memory_order_relaxed);
+    }
+
+    void recordSkipped() { skipped_messages_.fetch_add(1, std::memory_order_relaxed); }
+
+    void recordInflate(size_t compressed, size_t raw, double cpu_seconds) {
+        inflated_messages_.fetch_add(1, std::memory_order_relaxed);
+        inflate_compressed_.fetch_add(compressed, std::memory_order_relaxed);
+        inflate_raw_.fetch_add(raw, std::memory_order_relaxed);
+        inflate_cpu_ns_.fetch_add(static_cast<uint64_t>(cpu_seconds * 1e9), std::memory_order_relaxed);
+    }
+
+    std::string exportPrometheus(const std::string& name = "ws_deflate") const {
+        uint64_t out_raw = deflate_raw_.load(std::memory_order_relaxed);
+        uint64_t out_compressed = deflate_compressed_.load(std::memory_order_relaxed);
+        uint64_t in_raw = inflate_raw_.load(std::memory_order_relaxed);
+        uint64_t in_compressed = inflate_compressed_.load(std::memory_order_relaxed);
+
+        std::ostringstream ss;
+        std::string prefix = "lchbot_" + name + "_";
+        ss << "# HELP " << prefix << "messages_total Data messages by compression outcome\n";
+        ss << "# TYPE " << prefix << "messages_total counter\n";
+        ss << prefix << "messages_total{outcome=\"deflated\"} " << deflated_messages_.load(std::memory_order_relaxed) << "\n";
+        ss << prefix << "messages_total{outcome=\"skipped\"} " << skipped_messages_.load(std::memory_order_relaxed) << "\n";
+        ss << prefix << "messages_total{outcome=\"inflated\"} " << inflated_messages_.load(std::memory_order_relaxed) << "\n\n";
+        ss << "# HELP " << prefix << "bytes_total Payload bytes before and after compression\n";
+        ss << "# TYPE " << prefix << "bytes_total counter\n";
+        ss << prefix << "bytes_total{direction=\"out\",form=\"raw\"} " << out_raw << "\n";
+        ss << prefix << "bytes_total{direction=\"out\",form=\"compressed\"} " << out_compressed << "\n";
+        ss << prefix << "bytes_total{direction=\"in\",form=\"raw\"} " << in_raw << "\n";
+        ss << prefix << "bytes_total{direction=\"in\",form=\"compressed\"} " << in_compressed << "\n\n";
+        ss << "# HELP " << prefix << "ratio Compressed bytes divided by raw bytes\n";
+        ss << "# TYPE " << prefix << "ratio gauge\n";
+        ss << prefix << "ratio{direction=\"out\"} " << ratio(out_compressed, out_raw) << "\n";
+        ss << prefix << "ratio{direction=\"in\"} " << ratio(in_compressed, in_raw) << "\n\n";
+        ss << "# HELP " << prefix << "cpu_seconds_total Thread CPU time spent compressing and decompressing\n";
+        ss << "# TYPE " << prefix << "cpu_seconds_total counter\n";
+        ss << prefix << "cpu_seconds_total{direction=\"out\"} " << deflate_cpu_ns_.load(std::memory_order_relaxed) / 1e9 << "\n";
+        ss << prefix << "cpu_seconds_total{direction=\"in\"} " << inflate_cpu_ns_.load(std::memory_order_relaxed) / 1e9 << "\n\n";
+        return ss.str();
+    }
+
+private:
+    static double ratio(uint64_t compressed, uint64_t raw) {
+        return raw == 0 ? 1.0 : static_cast<double>(compressed) / static_cast<double>(raw);
+    }
+
+    std::atomic<uint64_t> deflated_messages_{0};
+    std::atomic<uint64_t> skipped_messages_{0};
+    std::atomic<uint64_t> inflated_messages_{0};
+    std::atomic<uint64_t> deflate_raw_{0};
+    std::atomic<uint64_t> deflate_compressed_{0};
+    std::atomic<uint64_t> inflate_raw_{0};
+    std::atomic<uint64_t> inflate_compressed_{0};
+    std::atomic<uint64_t> deflate_cpu_ns_{0};
+    std::atomic<uint64_t> inflate_cpu_ns_{0};
+};
+
+class MessageDeflater {
+public:
+    MessageDeflater(int window_bits, bool reset_each, int level) : reset_each_(reset_each) {
+#ifdef LCHBOT_HAS_ZLIB
+        stream_ = std::make_unique<z_stream>();
+        if (deflateInit2(stream_.get(), level, Z_DEFLATED, -window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("Failed to initialise deflate stream");
+        }
+#else
+        (void)window_bits;
+        (void)level;
+        throw std::runtime_error("permessage-deflate requires zlib");
+#endif
+    }
+
+    ~MessageDeflater() {
+#ifdef LCHBOT_HAS_ZLIB
+        deflateEnd(stream_.get());
+#endif
+    }
+
+    MessageDeflater(const MessageDeflater&) = delete;
+    MessageDeflater& operator=(const MessageDeflater&) = delete;
+
+    bool compress(std::string_view input, std::string& output) {
+#ifdef LCHBOT_HAS_ZLIB
+        double cpu_start = DeflateStats::threadCpuSeconds();
+        z_stream* z = stream_.get();
+        output.resize(deflateBound(z, static_cast<uLong>(input.size())) + 16);
+        z->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        z->avail_in = static_cast<uInt>(input.size());
+        size_t produced = 0;
+
+        while (true) {
+            z->next_out = reinterpret_cast<Bytef*>(output.data() + produced);
+            z->avail_out = static_cast<uInt>(output.size() - produced);
+            int ret = deflate(z, Z_SYNC_FLUSH);
+            produced = output.size() - z->avail_out;
+            if (ret != Z_OK && ret != Z_BUF_ERROR) return false;
+            if (z->avail_out != 0) break;
+            output.resize(output.size() * 2);
+        }
+
+        if (produced >= 4 && std::memcmp(output.data() + produced - 4, kTail, 4) == 0) {
+            produced -= 4;
+        }
+        output.resize(produced);
+        if (reset_each_) deflateReset(z);
+
+        DeflateStats::instance().recordDeflate(input.size(), output.size(), DeflateStats::threadCpuSeconds() - cpu_start);
+        return true;
+#else
+        (void)input;
+        (void)output;
+        return false;
+#endif
+    }
+
+private:
+    static constexpr char kTail[4] = {0x00, 0x00, static_cast<char>(0xFF), static_cast<char>(0xFF)};
+
+#ifdef LCHBOT_HAS_ZLIB
+    std::unique_ptr<z_stream> stream_;
+#endif
+    bool reset_each_;
+};
+
+class MessageInflater {
+public:
+    explicit MessageInflater(bool reset_each) : reset_each_(reset_each), buffer_(64 * 1024) {
+#ifdef LCHBOT_HAS_ZLIB
+        stream_ = std::make_unique<z_stream>();
+        if (inflateInit2(stream_.get(), -15) != Z_OK) {
+            throw std::runtime_error("Failed to initialise inflate stream");
+        }
+#else
+        throw std::runtime_error("permessage-deflate requires zlib");
+#endif
+    }
+
+    ~MessageInflater() {
+#ifdef LCHBOT_HAS_ZLIB
+        inflateEnd(stream_.get());
+#endif
+    }
+
+    MessageInflater(const MessageInflater&) = delete;
+    MessageInflater& operator=(const MessageInflater&) = delete;
+
+    template <typename Sink>
+    bool inflate(std::string_view input, Sink&& sink) {
+        if (input.empty()) return true;
+        double cpu_start = DeflateStats::threadCpuSeconds();
+        compressed_ += input.size();
+        bool ok = run(input, sink);
+        cpu_seconds_ += DeflateStats::threadCpuSeconds() - cpu_start;
+        return ok;
+    }
+
+    template <typename Sink>
+    bool finish(Sink&& sink) {
+        double cpu_start = DeflateStats::threadCpuSeconds();
+        bool ok = run(std::string_view(kTail, 4), sink);
+#ifdef LCHBOT_HAS_ZLIB
+        if (reset_each_ || !ok) inflateReset(stream_.get());
+#endif
+        cpu_seconds_ += DeflateStats::threadCpuSeconds() - cpu_start;
+        DeflateStats::instance().recordInflate(compressed_, raw_, cpu_seconds_);
+        compressed_ = 0;
+        raw_ = 0;
+        cpu_seconds_ = 0;
+        return ok;
+    }
+
+private:
+    static constexpr char kTail[4] = {0x00, 0x00, static_cast<char>(0xFF), static_cast<char>(0xFF)};
+
+    template <typename Sink>
+    bool run(std::string_view input, Sink& sink) {
+#ifdef LCHBOT_HAS_ZLIB
+        z_stream* z = stream_.get();
+        z->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        z->avail_in = static_cast<uInt>(input.size());
+
+        while (true) {
+            z->next_out = reinterpret_cast<Bytef*>(buffer_.data());
+            z->avail_out = static_cast<uInt>(buffer_.size());
+            int ret = ::inflate(z, Z_SYNC_FLUSH);
+            size_t produced = buffer_.size() - z->avail_out;
+            if (ret != Z_OK && ret != Z_BUF_ERROR && ret != Z_STREAM_END) return false;
+            if (produced > 0) {
+                raw_ += produced;
+                if (!sink(std::string_view(buffer_.data(), produced))) return false;
+            }
+            if (ret == Z_STREAM_END) {
+                inflateReset(z);
+                if (z->avail_in == 0) return true;
+                continue;
+            }
+            if (z->avail_out != 0 && (z->avail_in == 0 || ret == Z_BUF_ERROR)) return z->avail_in == 0;
+        }
+#else
+        (void)input;
+        (void)sink;
+        return false;
+#endif
+    }
+
+#ifdef LCHBOT_HAS_ZLIB
+    std::unique_ptr<z_stream> stream_;
+#endif
+    bool reset_each_;
+    std::vector<char> buffer_;
+    size_t compressed_ = 0;
+    size_t raw_ = 0;
+    double cpu_seconds_ = 0;
+};
+
+class PerMessageDeflate {
+public:
+    static constexpr const char* kName = "permessage-deflate";
+
+    static bool available() {
+#ifdef LCHBOT_HAS_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static int clampWindowBits(int bits) { return std::clamp(bits, 9, 15); }
+
+    static std::string offer(const DeflateOptions& options) {
+        int bits = clampWindowBits(options.window_bits);
+        std::string value = kName;
+        value += "; client_max_window_bits";
+        if (bits < 15) {
+            value += "=" + std::to_string(bits);
+            value += "; server_max_window_bits=" + std::to_string(bits);
+        }
+        if (!options.context_takeover) {
+            value += "; client_no_context_takeover; server_no_context_takeover";
+        }
+        return value;
+    }
+
+    static bool accept(const std::string& response, const DeflateOptions& options, DeflateParams& params) {
+        std::vector<Extension> extensions = parse(response);
+        if (extensions.size() != 1 || extensions[0].name != kName) return false;
+
+        params = DeflateParams();
+        params.deflate_window_bits = clampWindowBits(options.window_bits);
+        params.deflate_reset = !options.context_takeover;
+        params.inflate_reset = !options.context_takeover;
+
+        for (const auto& [key, value] : extensions[0].params) {
+            if (key == "server_no_context_takeover" && value.empty()) {
+                params.inflate_reset = true;
+            } else if (key == "client_no_context_takeover" && value.empty()) {
+                params.deflate_reset = true;
+            } else if (key == "server_max_window_bits") {
+                if (windowBits(value) < 0) return false;
+            } else if (key == "client_max_window_bits") {
+                int bits = windowBits(value);
+                if (bits < 9) return false;
+                params.deflate_window_bits = std::min(params.deflate_window_bits, bits);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool negotiate(const std::string& offers, const DeflateOptions& options,
+                          DeflateParams& params, std::string& response) {
+        int limit = clampWindowBits(options.window_bits);
+        for (const auto& extension : parse(offers)) {
+            if (extension.name != kName) continue;
+
+            bool valid = true;
+            bool client_bits_supported = false;
+            int client_bits = 15;
+            int server_bits = 15;
+            bool client_no_takeover = !options.context_takeover;
+            bool server_no_takeover = !options.context_takeover;
+
+            for (const auto& [key, value] : extension.params) {
+                if (key == "server_no_context_takeover" && value.empty()) {
+                    server_no_takeover = true;
+                } else if (key == "client_no_context_takeover" && value.empty()) {
+                    client_no_takeover = true;
+                } else if (key == "server_max_window_bits") {
+                    server_bits = windowBits(value);
+                    if (server_bits < 9) valid = false;
+                } else if (key == "client_max_window_bits") {
+                    client_bits_supported = true;
+                    if (!value.empty()) {
+                        client_bits = windowBits(value);
+                        if (client_bits < 8) valid = false;
+                    }
+                } else {
+                    valid = false;
+                }
+            }
+            if (!valid) continue;
+
+            server_bits = std::min(server_bits, limit);
+            params = DeflateParams();
+            params.deflate_window_bits = server_bits;
+            params.deflate_reset = server_no_takeover;
+            params.inflate_reset = client_no_takeover;
+
+            response = kName;
+            if (server_no_takeover) response += "; server_no_context_takeover";
+            if (client_no_takeover) response += "; client_no_context_takeover";
+            if (server_bits < 15) response += "; server_max_window_bits=" + std::to_string(server_bits);
+            int client_limit = std::min(client_bits, limit);
+            if (client_bits_supported && client_limit >= 9 && client_limit < 15) {
+                response += "; client_max_window_bits=" + std::to_string(client_limit);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    static std::string headerValue(const std::string& head, const std::string& name) {
+        std::string result;
+        std::istringstream iss(head);
+        std::string line;
+        while (std::getline(iss, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            size_t colon = line.find(':');
+            if (colon == std::string::npos || colon != name.size()) continue;
+            bool match = std::equal(name.begin(), name.end(), line.begin(), [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            });
+            if (!match) continue;
+            if (!result.empty()) result += ", ";
+            result += trim(line.substr(colon + 1));
+        }
+        return result;
+    }
+
+private:
+    struct Extension {
+        std::string name;
+        std::vector<std::pair<std::string, std::string>> params;
+    };
+
+    static std::string trim(const std::string& text) {
+        size_t begin = text.find_first_not_of(" \t");
+        if (begin == std::string::npos) return std::string();
+        size_t end = text.find_last_not_of(" \t");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    static std::vector<std::string> split(const std::string& text, char separator) {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        while (true) {
+            size_t pos = text.find(separator, start);
+            parts.push_back(trim(text.substr(start, pos - start)));
+            if (pos == std::string::npos) break;
+            start = pos + 1;
+        }
+        return parts;
+    }
+
+    static std::vector<Extension> parse(const std::string& header) {
+        std::vector<Extension> extensions;
+        for (const auto& item : split(header, ',')) {
+            if (item.empty()) continue;
+            std::vector<std::string> tokens = split(item, ';');
+            Extension extension;
+            extension.name = tokens[0];
+            for (size_t i = 1; i < tokens.size(); ++i) {
+                size_t eq = tokens[i].find('=');
+                std::string key = trim(tokens[i].substr(0, eq));
+                std::string value = eq == std::string::npos ? std::string() : trim(tokens[i].substr(eq + 1));
+                if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+                    value = value.substr(1, value.size() - 2);
+                }
+                extension.params.emplace_back(key, value);
+            }
+            extensions.push_back(std::move(extension));
+        }
+        return extensions;
+    }
+
+    static int windowBits(const std::string& value) {
+        if (value.empty() || value.size() > 2 || !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) return -1;
+        int bits = std::stoi(value);
+        return bits >= 8 && bits <= 15 ? bits : -1;
+    }
+};
+
+}
@@ -11,6 +11,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #define SOCKET int
 #define INVALID_SOCKET -1
@@ -28,7 +29,16 @@
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <algorithm>
+#include <memory>
+#include <deque>
+#include <condition_variable>
 #include "../core/Logger.h"
+#include "../core/JsonPushParser.h"
+#include "../core/WorkerPool.h"
+#include "FrameDecoder.h"
+#include "PerMessageDeflate.h"
+#include "WebSocketMask.h"
 
 namespace LCHBOT {
 
@@ -38,8 +48,12 @@ public:
     using ConnectCallback = std::function<void()>;
     using DisconnectCallback = std::function<void()>;
     using ErrorCallback = std::function<void(const std::string&)>;
+    using DocumentCallback = std::function<void(std::shared_ptr<JsonDocument>)>;
+    using PongCallback = std::function<void(double)>;
+    using Clock = std::chrono::steady_clock;
     
-    WebSocketClient() : running_(false), socket_(INVALID_SOCKET) {
+    explicit WebSocketClient(WorkerPool& workers = WorkerPool::instance())
+        : running_(false), socket_(INVALID_SOCKET), workers_(workers) {
 #ifdef _WIN32
         WSADATA wsa_data;
         WSAStartup(MAKEWORD(2, 2), &wsa_data);
@@ -53,7 +67,26 @@ public:
 #endif
     }
     
+    struct SendStats {
+        uint64_t frames = 0;
+        uint64_t syscalls = 0;
+        uint64_t bytes = 0;
+    };
+    
+    struct LinkStats {
+        uint64_t pings_sent = 0;
+        uint64_t pongs_received = 0;
+        uint64_t dead_peers = 0;
+        uint64_t buffered = 0;
+        uint64_t replayed = 0;
+        uint64_t dropped = 0;
+        size_t backlog = 0;
+        double last_rtt_seconds = 0;
+    };
+    
     bool connect(const std::string& host, uint16_t port, const std::string& path = "/") {
+        releaseConnection();
+        
         host_ = host;
         port_ = port;
         path_ = path;
@@ -93,7 +126,22 @@ public:
             return false;
         }
         
+#ifdef _WIN32
+        DWORD send_timeout = kSendTimeoutMs;
+#else
+        timeval send_timeout{kSendTimeoutMs / 1000, (kSendTimeoutMs % 1000) * 1000};
+#endif
+        setsockopt(socket_, SOL_SOCKET, SO_SNDTIMEO, (const char*)&send_timeout, sizeof(send_timeout));
+        
+        {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            outbound_.clear();
+            replayBacklog();
+            writer_active_ = true;
+        }
+        touch();
         running_ = true;
+        send_thread_ = std::thread(&WebSocketClient::sendLoop, this);
         recv_thread_ = std::thread(&WebSocketClient::recvLoop, this);
         
         if (on_connect_) on_connect_();
@@ -103,44 +151,135 @@ public:
     
     void disconnect() {
         running_ = false;
-        
-        {
-            std::lock_guard<std::mutex> lock(send_mutex_);
-            if (socket_ != INVALID_SOCKET) {
-                std::vector<uint8_t> close_frame = encodeFrame("", 0x08, true);
-                ::send(socket_, (const char*)close_frame.data(), (int)close_frame.size(), 0);
-                closesocket(socket_);
-                socket_ = INVALID_SOCKET;
-            }
-        }
-        
-        if (recv_thread_.joinable()) {
-            recv_thread_.join();
-        }
+        stopWriter(true);
+        joinOrDetach(send_thread_);
+        releaseConnection();
     }
     
     void send(const std::string& message) {
-        std::lock_guard<std::mutex> lock(send_mutex_);
-        if (socket_ == INVALID_SOCKET) {
+        send(std::string(message));
+    }
+    
+    void send(std::string&& message) {
+        if (!queueFrame(0x01, std::move(message), true)) {
             LOG_WARN("[WebSocket] Send failed: socket invalid");
-            return;
-        }
-        
-        std::vector<uint8_t> frame = encodeFrame(message, 0x01, true);
-        int sent = ::send(socket_, (const char*)frame.data(), (int)frame.size(), 0);
-        if (sent < 0) {
-            LOG_ERROR("[WebSocket] Send error: " + std::to_string(sent));
         }
     }
     
+    SendStats sendStats() const {
+        SendStats stats;
+        stats.frames = frames_sent_.load(std::memory_order_relaxed);
+        stats.syscalls = send_syscalls_.load(std::memory_order_relaxed);
+        stats.bytes = bytes_sent_.load(std::memory_order_relaxed);
+        return stats;
+    }
+    
+    LinkStats linkStats() const {
+        LinkStats stats;
+        stats.pings_sent = pings_sent_.load(std::memory_order_relaxed);
+        stats.pongs_received = pongs_received_.load(std::memory_order_relaxed);
+        stats.dead_peers = dead_peers_.load(std::memory_order_relaxed);
+        stats.last_rtt_seconds = last_rtt_us_.load(std::memory_order_relaxed) / 1e6;
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        stats.buffered = buffered_;
+        stats.replayed = replayed_;
+        stats.dropped = dropped_;
+        stats.backlog = backlog_.size();
+        return stats;
+    }
+    
+    std::string exportPrometheus(const std::string& name = "ws_link") const {
+        LinkStats s = linkStats();
+        std::ostringstream ss;
+        std::string prefix = "lchbot_" + name + "_";
+        ss << "# HELP " << prefix << "rtt_seconds Round-trip time of the most recent ping\n";
+        ss << "# TYPE " << prefix << "rtt_seconds gauge\n";
+        ss << prefix << "rtt_seconds " << s.last_rtt_seconds << "\n\n";
+        ss << "# HELP " << prefix << "pings_total Heartbeat pings by outcome\n";
+        ss << "# TYPE " << prefix << "pings_total counter\n";
+        ss << prefix << "pings_total{outcome=\"sent\"} " << s.pings_sent << "\n";
+        ss << prefix << "pings_total{outcome=\"answered\"} " << s.pongs_received << "\n\n";
+        ss << "# HELP " << prefix << "dead_peers_total Connections dropped by the dead-peer timeout\n";
+        ss << "# TYPE " << prefix << "dead_peers_total counter\n";
+        ss << prefix << "dead_peers_total " << s.dead_peers << "\n\n";
+        ss << "# HELP " << prefix << "backlog Messages waiting for the link to come back\n";
+        ss << "# TYPE " << prefix << "backlog gauge\n";
+        ss << prefix << "backlog " << s.backlog << "\n\n";
+        ss << "# HELP " << prefix << "outage_messages_total Messages sent while disconnected, by outcome\n";
+        ss << "# TYPE " << prefix << "outage_messages_total counter\n";
+        ss << prefix << "outage_messages_total{outcome=\"buffered\"} " << s.buffered << "\n";
+        ss << prefix << "outage_messages_total{outcome=\"replayed\"} " << s.replayed << "\n";
+        ss << prefix << "outage_messages_total{outcome=\"dropped\"} " << s.dropped << "\n\n";
+        return ss.str();
+    }
+    
     bool isConnected() const { return running_ && socket_ != INVALID_SOCKET; }
     
     void setMessageCallback(MessageCallback callback) { on_message_ = std::move(callback); }
     void setConnectCallback(ConnectCallback callback) { on_connect_ = std::move(callback); }
     void setDisconnectCallback(DisconnectCallback callback) { on_disconnect_ = std::move(callback); }
     void setErrorCallback(ErrorCallback callback) { on_error_ = std::move(callback); }
+    void setDocumentCallback(DocumentCallback callback) { on_document_ = std::move(callback); }
+    void setInlineDispatch(bool enabled) { inline_dispatch_ = enabled; }
+    void setCompression(const DeflateOptions& options) { deflate_options_ = options; }
+    void setMaxMessageSize(uint64_t bytes) { max_message_size_ = bytes; }
+    void setPongCallback(PongCallback callback) { on_pong_ = std::move(callback); }
+    
+    void setHeartbeat(uint32_t interval_ms, uint32_t timeout_ms) {
+        heartbeat_interval_ = std::chrono::milliseconds(interval_ms);
+        heartbeat_timeout_ = std::chrono::milliseconds(timeout_ms);
+    }
+    
+    void setOutageBuffer(size_t max_messages, uint32_t max_age_ms) {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        backlog_limit_ = max_messages;
+        backlog_max_age_ = std::chrono::milliseconds(max_age_ms);
+    }
+    bool compressionActive() const { return deflater_ != nullptr; }
     
 private:
+    static constexpr size_t kMaxBatch = 64;
+    static constexpr uint64_t kDefaultMaxMessageSize = 64ull * 1024 * 1024;
+    static constexpr uint32_t kSendTimeoutMs = 5000;
+    
+    struct PendingMessage {
+        std::string payload;
+        Clock::time_point queued;
+    };
+    
+    struct OutboundFrame {
+        uint8_t opcode = 0;
+        uint8_t header[FrameDecoder::kMaxHeader];
+        size_t header_len = 0;
+        uint8_t mask_key[4];
+        size_t slice_end = 0;
+        std::string payload;
+        std::string sealed;
+    };
+    
+#ifdef _WIN32
+    using IoSlice = WSABUF;
+    static IoSlice makeSlice(const void* data, size_t len) { return IoSlice{static_cast<ULONG>(len), (CHAR*)data}; }
+    static size_t sliceLength(const IoSlice& slice) { return slice.len; }
+    static void advanceSlice(IoSlice& slice, size_t n) { slice.buf += n; slice.len -= static_cast<ULONG>(n); }
+#else
+    using IoSlice = iovec;
+    static IoSlice makeSlice(const void* data, size_t len) { return IoSlice{const_cast<void*>(data), len}; }
+    static size_t sliceLength(const IoSlice& slice) { return slice.iov_len; }
+    static void advanceSlice(IoSlice& slice, size_t n) { slice.iov_base = static_cast<char*>(slice.iov_base) + n; slice.iov_len -= n; }
+#endif
+    
+    struct InboundMessage {
+        bool active = false;
+        bool streaming = false;
+        bool discard = false;
+        bool compressed = false;
+        bool oversized = false;
+        uint8_t opcode = 0;
+        uint64_t size = 0;
+        std::string payload;
+    };
+    
     bool performHandshake() {
         std::random_device rd;
         std::mt19937 gen(rd());
@@ -152,6 +291,7 @@ private:
         }
         
         std::string key = base64Encode(key_bytes, 16);
+        mask_state_ = (static_cast<uint64_t>(rd()) << 32) | rd();
         
         std::ostringstream request;
         request << "GET " << path_ << " HTTP/1.1\r\n";
@@ -160,6 +300,12 @@ private:
         request << "Connection: Upgrade\r\n";
         request << "Sec-WebSocket-Key: " << key << "\r\n";
         request << "Sec-WebSocket-Version: 13\r\n";
+        deflater_.reset();
+        inflater_.reset();
+        bool offer_deflate = deflate_options_.enabled && PerMessageDeflate::available();
+        if (offer_deflate) {
+            request << "Sec-WebSocket-Extensions: " << PerMessageDeflate::offer(deflate_options_) << "\r\n";
+        }
         request << "\r\n";
         
         std::string req = request.str();
@@ -167,14 +313,21 @@ private:
             return false;
         }
         
-        char buffer[4096];
-        int received = recv(socket_, buffer, sizeof(buffer) - 1, 0);
-        if (received <= 0) {
-            return false;
+        std::string response;
+        size_t header_end = std::string::npos;
+        while (header_end == std::string::npos) {
+            char buffer[4096];
+            int received = recv(socket_, buffer, sizeof(buffer), 0);
+            if (received <= 0 || response.size() > 16 * 1024) {
+                return false;
+            }
+            response.append(buffer, static_cast<size_t>(received));
+            header_end = response.find("\r\n\r\n");
         }
         
-        buffer[received] = '\0';
-        std::string response(buffer);
+        decoder_.reset();
+        decoder_.append(response.data() + header_end + 4, response.size() - header_end - 4);
+        response.resize(header_end + 4);
         
         if (response.find("101") == std::string::npos) {
             return false;
@@ -185,139 +338,493 @@ private:
             return false;
         }
         
+        std::string extensions = PerMessageDeflate::headerValue(response, "Sec-WebSocket-Extensions");
+        if (!extensions.empty()) {
+            DeflateParams params;
+            if (!offer_deflate || !PerMessageDeflate::accept(extensions, deflate_options_, params)) {
+                LOG_ERROR("[WebSocket] Server selected unsupported extensions: " + extensions);
+                return false;
+            }
+            deflater_ = std::make_unique<MessageDeflater>(params.deflate_window_bits, params.deflate_reset, deflate_options_.level);
+            inflater_ = std::make_unique<MessageInflater>(params.inflate_reset);
+            LOG_INFO("[WebSocket] Negotiated " + extensions);
+        }
+        
         return true;
     }
     
     void recvLoop() {
-        std::vector<uint8_t> buffer(1024 * 1024);
-        std::vector<uint8_t> pending_data;
+        message_ = InboundMessage();
+        control_.clear();
         
-        while (running_) {
-            int received = recv(socket_, (char*)buffer.data(), (int)buffer.size(), 0);
+        while (running_ && processIncoming()) {
+            auto [buffer, room] = decoder_.writable();
+            int received = recv(socket_, buffer, (int)room, 0);
             
             if (received <= 0) {
-                LOG_WARN("[WebSocket] recv returned " + std::to_string(received) + ", errno=" + std::to_string(WSAGetLastError()));
+                LOG_WARN("[WebSocket] recv returned " + std::to_string(received) + ", errno=" + std::to_string(lastSocketError()));
                 break;
             }
             
-            pending_data.insert(pending_data.end(), buffer.begin(), buffer.begin() + received);
-            
-            size_t offset = 0;
-            while (offset < pending_data.size()) {
-                auto [opcode, payload, consumed] = decodeFrame(pending_data.data() + offset, pending_data.size() - offset);
-                if (consumed == 0) break;
-                
-                offset += consumed;
-                
-                if (opcode == 0x08) {
-                    LOG_WARN("[WebSocket] Received close frame from server");
-                    goto disconnect_label;
-                } else if (opcode == 0x09) {
-                    std::vector<uint8_t> pong_frame = encodeFrame(payload, 0x0A, true);
-                    {
-                        std::lock_guard<std::mutex> lock(send_mutex_);
-                        if (socket_ != INVALID_SOCKET) {
-                            ::send(socket_, (const char*)pong_frame.data(), (int)pong_frame.size(), 0);
-                        }
-                    }
-                } else if (opcode == 0x01 || opcode == 0x02) {
-                    if (on_message_) {
-                        std::string msg_copy = payload;
-                        std::thread([this, msg_copy]() {
-                            on_message_(msg_copy);
-                        }).detach();
-                    }
-                }
-            }
-            
-            if (offset > 0) {
-                pending_data.erase(pending_data.begin(), pending_data.begin() + offset);
-            }
+            decoder_.commit(static_cast<size_t>(received));
+            touch();
         }
         
-    disconnect_label:
+        push_parser_.reset();
+        stopWriter(false);
         if (running_) {
             running_ = false;
             if (on_disconnect_) on_disconnect_();
         }
     }
     
-    std::vector<uint8_t> encodeFrame(const std::string& payload, uint8_t opcode, bool mask) {
-        std::vector<uint8_t> frame;
-        frame.push_back(0x80 | opcode);
+    bool processIncoming() {
+        FrameChunk chunk;
+        while (decoder_.next(chunk)) {
+            const FrameHeader& header = *chunk.header;
+            if (header.opcode >= 0x08) {
+                if (!handleControl(chunk)) return false;
+                continue;
+            }
+            if (chunk.begin && !beginFrame(header)) return false;
+            if (!appendPayload(chunk)) return false;
+            if (chunk.end && header.fin && !completeMessage(chunk)) return false;
+        }
+        return true;
+    }
+    
+    bool handleControl(const FrameChunk& chunk) {
+        const FrameHeader& header = *chunk.header;
+        if (chunk.begin && (!header.fin || header.rsv1 || header.length > 125)) {
+            return fail(1002, "Malformed control frame");
+        }
+        if (!chunk.whole()) {
+            if (chunk.begin) control_.clear();
+            control_.append(chunk.data.data(), chunk.data.size());
+            if (!chunk.end) return true;
+        }
+        std::string_view payload = chunk.whole() ? chunk.data : std::string_view(control_);
         
-        uint8_t mask_bit = mask ? 0x80 : 0x00;
+        if (header.opcode == 0x08) {
+            LOG_WARN("[WebSocket] Received close frame from server");
+            queueFrame(0x08, std::string(payload.substr(0, 2)));
+            return false;
+        }
         
-        if (payload.size() < 126) {
-            frame.push_back(mask_bit | static_cast<uint8_t>(payload.size()));
-        } else if (payload.size() < 65536) {
-            frame.push_back(mask_bit | 126);
-            frame.push_back((payload.size() >> 8) & 0xFF);
-            frame.push_back(payload.size() & 0xFF);
-        } else {
-            frame.push_back(mask_bit | 127);
-            for (int i = 7; i >= 0; --i) {
-                frame.push_back((payload.size() >> (i * 8)) & 0xFF);
+        if (header.opcode == 0x09) {
+            queueFrame(0x0A, std::string(payload));
+        } else if (header.opcode == 0x0A && payload.size() == sizeof(int64_t)) {
+            int64_t sent;
+            std::memcpy(&sent, payload.data(), sizeof(sent));
+            int64_t rtt_us = (nowMicros() - sent);
+            if (rtt_us >= 0 && rtt_us < 3600ll * 1000000) {
+                pongs_received_.fetch_add(1, std::memory_order_relaxed);
+                last_rtt_us_.store(rtt_us, std::memory_order_relaxed);
+                if (on_pong_) on_pong_(rtt_us / 1e6);
             }
         }
+        return true;
+    }
+    
+    bool beginFrame(const FrameHeader& header) {
+        if (header.opcode == 0x00) {
+            if (!message_.active || header.rsv1) return fail(1002, "Unexpected continuation frame");
+        } else if (header.opcode == 0x01 || header.opcode == 0x02) {
+            if (message_.active) return fail(1002, "Data frame interleaved with fragmented message");
+            if (header.rsv1 && !inflater_) return fail(1002, "Compressed frame without negotiated permessage-deflate");
+            message_ = InboundMessage();
+            message_.active = true;
+            message_.opcode = header.opcode;
+            message_.compressed = header.rsv1;
+            if (on_document_) {
+                message_.streaming = true;
+                push_parser_.begin(static_cast<size_t>(std::min<uint64_t>(header.length, max_message_size_)));
+            }
+        } else {
+            return fail(1002, "Unknown opcode " + std::to_string(header.opcode));
+        }
         
-        if (mask) {
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_int_distribution<> dis(0, 255);
-            
-            uint8_t mask_key[4];
-            for (int i = 0; i < 4; ++i) {
-                mask_key[i] = static_cast<uint8_t>(dis(gen));
-                frame.push_back(mask_key[i]);
+        if (!message_.compressed && message_.size + header.length > max_message_size_) {
+            return fail(1009, "Message exceeds " + std::to_string(max_message_size_) + " bytes");
+        }
+        return true;
+    }
+    
+    bool appendPayload(const FrameChunk& chunk) {
+        if (chunk.data.empty()) return true;
+        if (message_.compressed) {
+            if (inflater_->inflate(chunk.data, [this](std::string_view data) { return deliver(data); })) return true;
+            return failMessage();
+        }
+        if (!message_.streaming && chunk.whole() && chunk.header->fin && chunk.header->opcode != 0x00) return true;
+        return deliver(chunk.data) || failMessage();
+    }
+    
+    bool deliver(std::string_view data) {
+        message_.size += data.size();
+        if (message_.size > max_message_size_) {
+            message_.oversized = true;
+            return false;
+        }
+        if (message_.discard) return true;
+        if (!message_.streaming) {
+            message_.payload.append(data.data(), data.size());
+            return true;
+        }
+        try {
+            push_parser_.feed(data);
+        } catch (const std::exception& e) {
+            LOG_ERROR("[WebSocket] Dropping malformed JSON message: " + std::string(e.what()));
+            push_parser_.reset();
+            message_.discard = true;
+        }
+        return true;
+    }
+    
+    bool failMessage() {
+        if (message_.oversized) {
+            return fail(1009, "Message exceeds " + std::to_string(max_message_size_) + " bytes");
+        }
+        return fail(1007, "Failed to inflate compressed message");
+    }
+    
+    bool fail(uint16_t code, const std::string& reason) {
+        LOG_ERROR("[WebSocket] " + reason + ", closing with " + std::to_string(code));
+        std::string payload;
+        payload.push_back(static_cast<char>(code >> 8));
+        payload.push_back(static_cast<char>(code & 0xFF));
+        payload += reason.substr(0, 123);
+        queueFrame(0x08, std::move(payload));
+        if (message_.streaming) push_parser_.reset();
+        message_ = InboundMessage();
+        return false;
+    }
+    
+    bool completeMessage(const FrameChunk& chunk) {
+        if (message_.compressed && !inflater_->finish([this](std::string_view data) { return deliver(data); })) {
+            return failMessage();
+        }
+        
+        InboundMessage message = std::move(message_);
+        message_ = InboundMessage();
+        if (message.discard) return true;
+        
+        if (message.streaming) {
+            std::shared_ptr<JsonDocument> doc;
+            try {
+                doc = push_parser_.finish();
+            } catch (const std::exception& e) {
+                LOG_ERROR("[WebSocket] Dropping malformed JSON message: " + std::string(e.what()));
+                push_parser_.reset();
+                return true;
             }
-            
-            for (size_t i = 0; i < payload.size(); ++i) {
-                frame.push_back(payload[i] ^ mask_key[i % 4]);
+            dispatching_.store(true, std::memory_order_relaxed);
+            if (inline_dispatch_) {
+                on_document_(std::move(doc));
+            } else if (!workers_.submit([this, doc = std::move(doc)]() mutable { on_document_(std::move(doc)); })) {
+                LOG_WARN("[WebSocket] Worker queue full, dropping inbound frame");
+            }
+            dispatching_.store(false, std::memory_order_relaxed);
+        } else if (on_message_) {
+            bool zero_copy = !message.compressed && chunk.whole() && chunk.header->opcode != 0x00;
+            std::string payload = zero_copy ? std::string(chunk.data) : std::move(message.payload);
+            dispatching_.store(true, std::memory_order_relaxed);
+            if (inline_dispatch_) {
+                on_message_(payload);
+            } else if (!workers_.submit([this, msg = std::move(payload)]() { on_message_(msg); })) {
+                LOG_WARN("[WebSocket] Worker queue full, dropping inbound frame");
             }
+            dispatching_.store(false, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    
+    void nextMaskKey(uint8_t mask_key[4]) {
+        uint64_t z = mask_state_.fetch_add(0x9E3779B97F4A7C15ull, std::memory_order_relaxed) + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        uint32_t key = static_cast<uint32_t>(z);
+        std::memcpy(mask_key, &key, 4);
+    }
+    
+    static size_t writeHeader(uint8_t* out, uint8_t opcode, bool compressed, size_t length, const uint8_t mask_key[4]) {
+        uint8_t* start = out;
+        *out++ = 0x80 | (compressed ? 0x40 : 0x00) | opcode;
+        
+        if (length < 126) {
+            *out++ = 0x80 | static_cast<uint8_t>(length);
+        } else if (length < 65536) {
+            *out++ = 0x80 | 126;
+            *out++ = (length >> 8) & 0xFF;
+            *out++ = length & 0xFF;
         } else {
-            frame.insert(frame.end(), payload.begin(), payload.end());
+            *out++ = 0x80 | 127;
+            for (int i = 7; i >= 0; --i) {
+                *out++ = (static_cast<uint64_t>(length) >> (i * 8)) & 0xFF;
+            }
         }
         
-        return frame;
+        std::memcpy(out, mask_key, 4);
+        return static_cast<size_t>(out + 4 - start);
     }
     
-    std::tuple<uint8_t, std::string, size_t> decodeFrame(const uint8_t* data, size_t len) {
-        if (len < 2) return {0, "", 0};
-        
-        uint8_t opcode = data[0] & 0x0F;
-        bool masked = (data[1] & 0x80) != 0;
-        uint64_t payload_len = data[1] & 0x7F;
-        size_t offset = 2;
+    bool queueFrame(uint8_t opcode, std::string payload, bool replayable = false) {
+        OutboundFrame frame;
+        frame.opcode = opcode;
+        frame.payload = std::move(payload);
         
-        if (payload_len == 126) {
-            if (len < 4) return {0, "", 0};
-            payload_len = (data[2] << 8) | data[3];
-            offset = 4;
-        } else if (payload_len == 127) {
-            if (len < 10) return {0, "", 0};
-            payload_len = 0;
-            for (int i = 0; i < 8; ++i) {
-                payload_len = (payload_len << 8) | data[2 + i];
+        {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            if (!writer_active_) {
+                if (!replayable || backlog_limit_ == 0) return false;
+                bufferForReplay(std::move(frame.payload));
+                return true;
             }
-            offset = 10;
+            outbound_.push_back(std::move(frame));
         }
-        
-        uint8_t mask[4] = {0};
-        if (masked) {
-            if (len < offset + 4) return {0, "", 0};
-            std::memcpy(mask, data + offset, 4);
-            offset += 4;
+        send_cv_.notify_one();
+        return true;
+    }
+    
+    void bufferForReplay(std::string payload) {
+        if (backlog_.size() >= backlog_limit_) {
+            backlog_.pop_front();
+            ++dropped_;
+        }
+        backlog_.push_back({std::move(payload), Clock::now()});
+        ++buffered_;
+    }
+    
+    void replayBacklog() {
+        Clock::time_point oldest = Clock::now() - backlog_max_age_;
+        size_t replayed = 0;
+        for (auto& pending : backlog_) {
+            if (pending.queued < oldest) {
+                ++dropped_;
+                continue;
+            }
+            OutboundFrame frame;
+            frame.opcode = 0x01;
+            frame.payload = std::move(pending.payload);
+            outbound_.push_back(std::move(frame));
+            ++replayed;
+        }
+        backlog_.clear();
+        replayed_ += replayed;
+        if (replayed > 0) {
+            LOG_INFO("[WebSocket] Replaying " + std::to_string(replayed) + " message(s) buffered during outage");
+        }
+    }
+    
+    void salvageOutbound() {
+        std::deque<OutboundFrame> control;
+        for (auto& frame : outbound_) {
+            if (frame.opcode != 0x01) {
+                control.push_back(std::move(frame));
+            } else if (backlog_limit_ > 0) {
+                bufferForReplay(std::move(frame.payload));
+            } else {
+                ++dropped_;
+            }
+        }
+        outbound_.swap(control);
+    }
+    
+    void requeueUnsent(std::vector<OutboundFrame>& batch, size_t sent_slices) {
+        for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+            if (it->slice_end <= sent_slices) break;
+            if (it->opcode != 0x01) continue;
+            if (it->sealed.empty()) {
+                WebSocketMask::apply(it->payload.data(), it->payload.size(), it->mask_key);
+            }
+            outbound_.push_front(std::move(*it));
+        }
+        batch.clear();
+    }
+    
+    static int64_t nowMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+    }
+    
+    void touch() { last_activity_us_.store(nowMicros(), std::memory_order_relaxed); }
+    
+    void checkHealth() {
+        if (dispatching_.load(std::memory_order_relaxed)) touch();
+        int64_t idle_us = nowMicros() - last_activity_us_.load(std::memory_order_relaxed);
+        if (heartbeat_timeout_.count() > 0 && idle_us > heartbeat_timeout_.count() * 1000) {
+            LOG_WARN("[WebSocket] No traffic for " + std::to_string(idle_us / 1000) + " ms, treating peer as dead");
+            dead_peers_.fetch_add(1, std::memory_order_relaxed);
+            touch();
+            shutdownSocket();
+            return;
         }
         
-        if (len < offset + payload_len) return {0, "", 0};
-        
-        std::string payload(payload_len, '\0');
-        for (size_t i = 0; i < payload_len; ++i) {
-            payload[i] = masked ? (data[offset + i] ^ mask[i % 4]) : data[offset + i];
+        OutboundFrame ping;
+        ping.opcode = 0x09;
+        int64_t sent = nowMicros();
+        ping.payload.assign(reinterpret_cast<const char*>(&sent), sizeof(sent));
+        outbound_.push_back(std::move(ping));
+        pings_sent_.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    void shutdownSocket() {
+        if (socket_ == INVALID_SOCKET) return;
+#ifdef _WIN32
+        shutdown(socket_, SD_BOTH);
+#else
+        shutdown(socket_, SHUT_RDWR);
+#endif
+    }
+    
+    std::string& sealFrame(OutboundFrame& frame) {
+        bool compressed = false;
+        if (deflater_ && (frame.opcode == 0x01 || frame.opcode == 0x02)) {
+            if (frame.payload.size() >= deflate_options_.min_size && deflater_->compress(frame.payload, frame.sealed)) {
+                compressed = true;
+            } else {
+                frame.sealed.clear();
+                DeflateStats::instance().recordSkipped();
+            }
         }
         
-        return {opcode, payload, offset + payload_len};
+        std::string& wire = compressed ? frame.sealed : frame.payload;
+        nextMaskKey(frame.mask_key);
+        frame.header_len = writeHeader(frame.header, frame.opcode, compressed, wire.size(), frame.mask_key);
+        WebSocketMask::apply(wire.data(), wire.size(), frame.mask_key);
+        return wire;
+    }
+    
+    void sendLoop() {
+        std::vector<OutboundFrame> batch;
+        std::vector<IoSlice> slices;
+        batch.reserve(kMaxBatch);
+        slices.reserve(kMaxBatch * 2);
+        Clock::time_point next_ping = Clock::now() + heartbeat_interval_;
+        
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(send_mutex_);
+                while (true) {
+                    if (heartbeat_interval_.count() > 0 && writer_active_ && Clock::now() >= next_ping) {
+                        checkHealth();
+                        next_ping = Clock::now() + heartbeat_interval_;
+                    }
+                    if (!outbound_.empty() || !writer_active_) break;
+                    if (heartbeat_interval_.count() == 0) {
+                        send_cv_.wait(lock);
+                    } else {
+                        send_cv_.wait_until(lock, next_ping);
+                    }
+                }
+                if (outbound_.empty()) return;
+                while (!outbound_.empty() && batch.size() < kMaxBatch) {
+                    batch.push_back(std::move(outbound_.front()));
+                    outbound_.pop_front();
+                }
+            }
+            
+            slices.clear();
+            for (auto& frame : batch) {
+                std::string& wire = sealFrame(frame);
+                slices.push_back(makeSlice(frame.header, frame.header_len));
+                if (!wire.empty()) {
+                    slices.push_back(makeSlice(wire.data(), wire.size()));
+                }
+                frame.slice_end = slices.size();
+            }
+            
+            size_t sent_slices = 0;
+            if (!writeSlices(slices, sent_slices)) {
+                LOG_ERROR("[WebSocket] Send error: " + std::to_string(lastSocketError()));
+                shutdownSocket();
+                std::lock_guard<std::mutex> lock(send_mutex_);
+                writer_active_ = false;
+                requeueUnsent(batch, sent_slices);
+                salvageOutbound();
+                return;
+            }
+            
+            frames_sent_.fetch_add(batch.size(), std::memory_order_relaxed);
+            batch.clear();
+        }
+    }
+    
+    bool writeSlices(std::vector<IoSlice>& slices, size_t& index) {
+        index = 0;
+        while (index < slices.size()) {
+            size_t count = slices.size() - index;
+#ifdef _WIN32
+            DWORD sent = 0;
+            if (WSASend(socket_, slices.data() + index, static_cast<DWORD>(count), &sent, 0, nullptr, nullptr) == SOCKET_ERROR) {
+                return false;
+            }
+#else
+            msghdr msg{};
+            msg.msg_iov = slices.data() + index;
+            msg.msg_iovlen = count;
+            ssize_t sent = sendmsg(socket_, &msg, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+#endif
+            send_syscalls_.fetch_add(1, std::memory_order_relaxed);
+            bytes_sent_.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+            
+            size_t remaining = static_cast<size_t>(sent);
+            while (index < slices.size() && remaining >= sliceLength(slices[index])) {
+                remaining -= sliceLength(slices[index]);
+                ++index;
+            }
+            if (remaining > 0) {
+                advanceSlice(slices[index], remaining);
+            }
+        }
+        return true;
+    }
+    
+    void stopWriter(bool send_close) {
+        {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            if (writer_active_ && send_close) {
+                OutboundFrame frame;
+                frame.opcode = 0x08;
+                outbound_.push_back(std::move(frame));
+            } else {
+                salvageOutbound();
+            }
+            writer_active_ = false;
+        }
+        send_cv_.notify_all();
+    }
+    
+    static void joinOrDetach(std::thread& thread) {
+        if (!thread.joinable()) return;
+        if (thread.get_id() == std::this_thread::get_id()) {
+            thread.detach();
+        } else {
+            thread.join();
+        }
+    }
+    
+    void releaseConnection() {
+        stopWriter(false);
+        shutdownSocket();
+        joinOrDetach(send_thread_);
+        joinOrDetach(recv_thread_);
+        if (socket_ != INVALID_SOCKET) {
+            closesocket(socket_);
+            socket_ = INVALID_SOCKET;
+        }
+    }
+    
+    static int lastSocketError() {
+#ifdef _WIN32
+        return WSAGetLastError();
+#else
+        return errno;
+#endif
     }
     
     std::string base64Encode(const uint8_t* data, size_t len) {
@@ -339,7 +846,34 @@ private:
     std::atomic<bool> running_;
     SOCKET socket_;
     std::thread recv_thread_;
+    std::thread send_thread_;
     mutable std::mutex send_mutex_;
+    std::condition_variable send_cv_;
+    std::deque<OutboundFrame> outbound_;
+    bool writer_active_ = false;
+    std::atomic<uint64_t> mask_state_{0};
+    std::atomic<uint64_t> frames_sent_{0};
+    std::atomic<uint64_t> send_syscalls_{0};
+    std::atomic<uint64_t> bytes_sent_{0};
+    std::deque<PendingMessage> backlog_;
+    size_t backlog_limit_ = 0;
+    std::chrono::milliseconds backlog_max_age_{0};
+    uint64_t buffered_ = 0;
+    uint64_t replayed_ = 0;
+    uint64_t dropped_ = 0;
+    std::chrono::milliseconds heartbeat_interval_{0};
+    std::chrono::milliseconds heartbeat_timeout_{0};
+    std::atomic<int64_t> last_activity_us_{0};
+    std::atomic<bool> dispatching_{false};
+    std::atomic<int64_t> last_rtt_us_{0};
+    std::atomic<uint64_t> pings_sent_{0};
+    std::atomic<uint64_t> pongs_received_{0};
+    std::atomic<uint64_t> dead_peers_{0};
+    WorkerPool& workers_;
+    bool inline_dispatch_ = false;
+    DeflateOptions deflate_options_;
+    std::unique_ptr<MessageDeflater> deflater_;
+    std::unique_ptr<MessageInflater> inflater_;
     
     std::string host_;
     uint16_t port_;
@@ -349,6 +883,14 @@ private:
     ConnectCallback on_connect_;
     DisconnectCallback on_disconnect_;
     ErrorCallback on_error_;
+    DocumentCallback on_document_;
+    PongCallback on_pong_;
+    
+    FrameDecoder decoder_{256 * 1024};
+    InboundMessage message_;
+    std::string control_;
+    uint64_t max_message_size_ = kDefaultMaxMessageSize;
+    JsonPushParser push_parser_;
 };
 
 }
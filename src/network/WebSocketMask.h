@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LCHBOT_MASK_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LCHBOT_MASK_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LCHBOT_MASK_NEON 1
+#endif
+
+namespace LCHBOT {
+
+class WebSocketMask {
+public:
+    static const char* backend() {
+#if defined(LCHBOT_MASK_AVX2)
+        return "avx2";
+#elif defined(LCHBOT_MASK_SSE2)
+        return "sse2";
+#elif defined(LCHBOT_MASK_NEON)
+        return "neon";
+#else
+        return "word";
+#endif
+    }
+
+    static void apply(char* data, size_t len, const uint8_t mask[4], uint64_t offset = 0) {
+        transform(data, data, len, mask, offset);
+    }
+
+    static void copy(char* dst, const char* src, size_t len, const uint8_t mask[4], uint64_t offset = 0) {
+        transform(dst, src, len, mask, offset);
+    }
+
+private:
+    static void transform(char* dst, const char* src, size_t len, const uint8_t mask[4], uint64_t offset) {
+        uint8_t key[8];
+        for (int i = 0; i < 8; ++i) {
+            key[i] = mask[(offset + i) & 3];
+        }
+
+        size_t i = 0;
+#if defined(LCHBOT_MASK_AVX2)
+        uint32_t word32;
+        std::memcpy(&word32, key, 4);
+        __m256i key256 = _mm256_set1_epi32(static_cast<int>(word32));
+        for (; i + 32 <= len; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(v, key256));
+        }
+        __m128i key128 = _mm256_castsi256_si128(key256);
+        for (; i + 16 <= len; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(v, key128));
+        }
+#elif defined(LCHBOT_MASK_SSE2)
+        uint32_t word32;
+        std::memcpy(&word32, key, 4);
+        __m128i key128 = _mm_set1_epi32(static_cast<int>(word32));
+        for (; i + 32 <= len; i += 32) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(a, key128));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), _mm_xor_si128(b, key128));
+        }
+        for (; i + 16 <= len; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(v, key128));
+        }
+#elif defined(LCHBOT_MASK_NEON)
+        uint32_t word32;
+        std::memcpy(&word32, key, 4);
+        uint8x16_t key128 = vreinterpretq_u8_u32(vdupq_n_u32(word32));
+        for (; i + 16 <= len; i += 16) {
+            uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+            vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), veorq_u8(v, key128));
+        }
+#endif
+        uint64_t word64;
+        std::memcpy(&word64, key, 8);
+        for (; i + 8 <= len; i += 8) {
+            uint64_t v;
+            std::memcpy(&v, src + i, 8);
+            v ^= word64;
+            std::memcpy(dst + i, &v, 8);
+        }
+        for (; i < len; ++i) {
+            dst[i] = static_cast<char>(src[i] ^ key[i & 3]);
+        }
+    }
+};
+
+}
@@ -24,6 +24,7 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <queue>
 #include <condition_variable>
@@ -31,16 +32,30 @@
 #include <random>
 #include <sstream>
 #include <iomanip>
+#include "EventLoop.h"
+#include "FrameDecoder.h"
+#include "PerMessageDeflate.h"
+#include "../core/Logger.h"
+#include "../core/TimerQueue.h"
+#include "../core/WorkerPool.h"
 
 namespace LCHBOT {
 
 class WebSocketServer {
 public:
     using MessageCallback = std::function<void(int, const std::string&)>;
+    using MessageHandler = std::function<bool(int, const std::string&)>;
     using ConnectCallback = std::function<void(int)>;
     using DisconnectCallback = std::function<void(int)>;
     
-    WebSocketServer() : running_(false), server_socket_(INVALID_SOCKET), next_client_id_(1) {
+    static constexpr size_t kMaxHandshake = 8192;
+    static constexpr size_t kInitialReadBuffer = 4 * 1024;
+    static constexpr uint64_t kDefaultMaxMessageSize = 64ull * 1024 * 1024;
+    static constexpr std::chrono::milliseconds kResumeInterval{5};
+    
+    explicit WebSocketServer(EventLoopGroup& loops = EventLoopGroup::instance(), WorkerPool& workers = WorkerPool::instance())
+        : running_(false), server_socket_(INVALID_SOCKET), next_client_id_(1),
+          loops_(loops), workers_(workers), callbacks_(std::make_shared<Callbacks>()) {
 #ifdef _WIN32
         WSADATA wsa_data;
         WSAStartup(MAKEWORD(2, 2), &wsa_data);
@@ -55,6 +70,8 @@ public:
     }
     
     bool start(const std::string& host, uint16_t port) {
+        if (running_) return false;
+        
         server_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
         if (server_socket_ == INVALID_SOCKET) {
             return false;
@@ -70,156 +87,563 @@ public:
         
         if (bind(server_socket_, (sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR) {
             closesocket(server_socket_);
+            server_socket_ = INVALID_SOCKET;
             return false;
         }
         
         if (listen(server_socket_, SOMAXCONN) == SOCKET_ERROR) {
             closesocket(server_socket_);
+            server_socket_ = INVALID_SOCKET;
             return false;
         }
         
+        EventLoop::setNonBlocking(server_socket_);
         running_ = true;
-        accept_thread_ = std::thread(&WebSocketServer::acceptLoop, this);
+        loops_.start();
+        listen_loop_ = &loops_.next();
+        listen_loop_->add(server_socket_, EventLoop::Readable, [this](uint32_t) { acceptReady(); });
         
         return true;
     }
     
     void stop() {
-        running_ = false;
+        if (!running_.exchange(false)) return;
         
         if (server_socket_ != INVALID_SOCKET) {
-            closesocket(server_socket_);
+            SOCKET listener = server_socket_;
+            listen_loop_->runSync([this, listener] { listen_loop_->remove(listener); });
+            closesocket(listener);
             server_socket_ = INVALID_SOCKET;
         }
         
+        std::map<int, std::shared_ptr<Connection>> clients;
         {
             std::lock_guard<std::mutex> lock(clients_mutex_);
-            for (auto& [id, client] : clients_) {
-                closesocket(client.socket);
-            }
-            clients_.clear();
+            clients.swap(clients_);
         }
-        
-        if (accept_thread_.joinable()) {
-            accept_thread_.join();
+        for (auto& [id, conn] : clients) {
+            conn->loop->runSync([this, conn = conn] { closeConnection(conn, false); });
         }
     }
     
     void send(int client_id, const std::string& message) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_id);
-        if (it == clients_.end()) return;
+        std::shared_ptr<Connection> conn = findClient(client_id);
+        if (!conn) return;
         
-        std::vector<uint8_t> frame = encodeFrame(message, 0x01);
-        ::send(it->second.socket, (const char*)frame.data(), (int)frame.size(), 0);
+        if (conn->deflater) {
+            queueMessage(conn, message);
+        } else {
+            queueFrame(conn, encodeFrame(message, 0x01));
+        }
     }
     
     void broadcast(const std::string& message) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        std::vector<uint8_t> frame = encodeFrame(message, 0x01);
-        for (auto& [id, client] : clients_) {
-            ::send(client.socket, (const char*)frame.data(), (int)frame.size(), 0);
+        std::vector<std::shared_ptr<Connection>> targets;
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex_);
+            targets.reserve(clients_.size());
+            for (auto& [id, conn] : clients_) {
+                if (conn->handshake_complete) targets.push_back(conn);
+            }
         }
+        
+        std::vector<uint8_t> frame;
+        for (auto& conn : targets) {
+            if (conn->deflater) {
+                queueMessage(conn, message);
+                continue;
+            }
+            if (frame.empty()) frame = encodeFrame(message, 0x01);
+            queueFrame(conn, frame);
+        }
+    }
+    
+    void setMessageCallback(MessageCallback callback) {
+        callbacks_->on_message = [callback = std::move(callback)](int client_id, const std::string& message) {
+            callback(client_id, message);
+            return true;
+        };
+    }
+    void setMessageHandler(MessageHandler handler) { callbacks_->on_message = std::move(handler); }
+    void setConnectCallback(ConnectCallback callback) { callbacks_->on_connect = std::move(callback); }
+    void setDisconnectCallback(DisconnectCallback callback) { callbacks_->on_disconnect = std::move(callback); }
+    void setCompression(const DeflateOptions& options) { deflate_options_ = options; }
+    void setAccessToken(const std::string& token) { access_token_ = token; }
+    void setInlineDispatch(bool enabled) { inline_dispatch_ = enabled; }
+    void setMaxMessageSize(uint64_t bytes) { max_message_size_ = bytes; }
+    
+    std::string requestHeader(int client_id, const std::string& name) const {
+        std::shared_ptr<Connection> conn = findClient(client_id);
+        if (!conn || !conn->handshake_complete) return std::string();
+        return PerMessageDeflate::headerValue(conn->request, name);
     }
     
-    void setMessageCallback(MessageCallback callback) { on_message_ = std::move(callback); }
-    void setConnectCallback(ConnectCallback callback) { on_connect_ = std::move(callback); }
-    void setDisconnectCallback(DisconnectCallback callback) { on_disconnect_ = std::move(callback); }
+    uint64_t rejectedHandshakes() const { return rejected_handshakes_.load(std::memory_order_relaxed); }
+    uint64_t pausedReads() const { return paused_reads_.load(std::memory_order_relaxed); }
     
     bool isRunning() const { return running_; }
     
+    size_t clientCount() const {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        return clients_.size();
+    }
+    
 private:
-    struct Client {
-        SOCKET socket;
-        std::thread recv_thread;
-        bool handshake_complete = false;
+    struct Callbacks {
+        MessageHandler on_message;
+        ConnectCallback on_connect;
+        DisconnectCallback on_disconnect;
+    };
+    
+    struct InboundMessage {
+        bool active = false;
+        bool compressed = false;
+        bool oversized = false;
+        uint8_t opcode = 0;
+        uint64_t size = 0;
+        std::string payload;
     };
     
-    void acceptLoop() {
+    struct Connection {
+        int id = 0;
+        SOCKET socket = INVALID_SOCKET;
+        EventLoop* loop = nullptr;
+        std::shared_ptr<Strand> strand;
+        std::atomic<bool> handshake_complete{false};
+        std::string handshake;
+        std::string request;
+        FrameDecoder decoder{kInitialReadBuffer};
+        InboundMessage message;
+        std::string control;
+        bool holding = false;
+        std::string held;
+        
+        std::mutex deflate_mutex;
+        std::unique_ptr<MessageDeflater> deflater;
+        std::unique_ptr<MessageInflater> inflater;
+        
+        std::mutex send_mutex;
+        std::string outbound;
+        bool paused = false;
+        bool closed = false;
+    };
+    
+    std::shared_ptr<Connection> findClient(int client_id) const {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        auto it = clients_.find(client_id);
+        return it == clients_.end() ? nullptr : it->second;
+    }
+    
+    void acceptReady() {
         while (running_) {
             sockaddr_in client_addr{};
-            int addr_len = sizeof(client_addr);
+            socklen_t addr_len = sizeof(client_addr);
             SOCKET client_socket = accept(server_socket_, (sockaddr*)&client_addr, &addr_len);
             
             if (client_socket == INVALID_SOCKET) {
-                if (!running_) break;
-                continue;
+                return;
             }
             
-            int client_id = next_client_id_++;
+            EventLoop::setNonBlocking(client_socket);
+            
+            auto conn = std::make_shared<Connection>();
+            conn->id = next_client_id_++;
+            conn->socket = client_socket;
+            conn->loop = &loops_.next();
+            conn->strand = std::make_shared<Strand>(workers_);
             
             {
                 std::lock_guard<std::mutex> lock(clients_mutex_);
-                clients_[client_id].socket = client_socket;
-                clients_[client_id].recv_thread = std::thread(&WebSocketServer::clientLoop, this, client_id);
+                clients_[conn->id] = conn;
             }
+            
+            std::weak_ptr<Connection> weak = conn;
+            conn->loop->add(client_socket, EventLoop::Readable, [this, weak](uint32_t events) {
+                if (auto conn = weak.lock()) onEvent(conn, events);
+            });
         }
     }
     
-    void clientLoop(int client_id) {
-        SOCKET socket;
-        {
-            std::lock_guard<std::mutex> lock(clients_mutex_);
-            socket = clients_[client_id].socket;
+    void onEvent(const std::shared_ptr<Connection>& conn, uint32_t events) {
+        if (events & EventLoop::Writable) {
+            if (!flush(conn)) {
+                closeConnection(conn, true);
+                return;
+            }
         }
         
-        if (!performHandshake(client_id, socket)) {
-            removeClient(client_id);
+        if (!(events & (EventLoop::Readable | EventLoop::Closed))) return;
+        if (conn->holding) {
+            if (events & EventLoop::Closed) closeConnection(conn, true);
             return;
         }
         
-        {
-            std::lock_guard<std::mutex> lock(clients_mutex_);
-            clients_[client_id].handshake_complete = true;
+        int received;
+        if (conn->handshake_complete) {
+            auto [buffer, room] = conn->decoder.writable();
+            received = recv(conn->socket, buffer, (int)room, 0);
+            if (received > 0) conn->decoder.commit(static_cast<size_t>(received));
+        } else {
+            char buffer[kMaxHandshake];
+            received = recv(conn->socket, buffer, (int)sizeof(buffer), 0);
+            if (received > 0) conn->handshake.append(buffer, static_cast<size_t>(received));
         }
         
-        if (on_connect_) on_connect_(client_id);
-        
-        std::vector<uint8_t> buffer(65536);
-        std::string message_buffer;
+        if (received < 0 && EventLoop::wouldBlock()) return;
+        if (received <= 0) {
+            closeConnection(conn, true);
+            return;
+        }
         
-        while (running_) {
-            int received = recv(socket, (char*)buffer.data(), (int)buffer.size(), 0);
+        if (!processInbound(conn)) {
+            closeConnection(conn, true);
+        }
+    }
+    
+    bool processInbound(const std::shared_ptr<Connection>& conn) {
+        if (!conn->handshake_complete) {
+            std::string& request = conn->handshake;
+            size_t end = request.find("\r\n\r\n");
+            if (end == std::string::npos) {
+                return request.size() <= kMaxHandshake;
+            }
             
-            if (received <= 0) {
-                break;
+            std::string head = request.substr(0, end + 4);
+            int status = authorize(head);
+            if (status != 0) {
+                ++rejected_handshakes_;
+                LOG_WARN("[WebSocketServer] Rejected client " + std::to_string(conn->id) + " with HTTP " + std::to_string(status));
+                std::string rejection = status == 401
+                    ? "HTTP/1.1 401 Unauthorized\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"
+                    : "HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                queueBytes(conn, rejection.data(), rejection.size());
+                return false;
             }
             
-            size_t offset = 0;
-            while (offset < (size_t)received) {
-                auto [opcode, payload, consumed] = decodeFrame(buffer.data() + offset, received - offset);
-                if (consumed == 0) break;
-                
-                offset += consumed;
-                
-                if (opcode == 0x08) {
-                    std::vector<uint8_t> close_frame = encodeFrame("", 0x08);
-                    ::send(socket, (const char*)close_frame.data(), (int)close_frame.size(), 0);
-                    goto disconnect;
-                } else if (opcode == 0x09) {
-                    std::vector<uint8_t> pong_frame = encodeFrame(payload, 0x0A);
-                    ::send(socket, (const char*)pong_frame.data(), (int)pong_frame.size(), 0);
-                } else if (opcode == 0x01 || opcode == 0x02) {
-                    if (on_message_) on_message_(client_id, payload);
+            std::string response = handshakeResponse(conn, head);
+            if (response.empty()) return false;
+            if (!queueBytes(conn, response.data(), response.size())) return false;
+            
+            conn->decoder.append(request.data() + end + 4, request.size() - end - 4);
+            std::string().swap(request);
+            conn->request = std::move(head);
+            conn->handshake_complete = true;
+            
+            int client_id = conn->id;
+            dispatch(conn, [callbacks = callbacks_, client_id] {
+                if (callbacks->on_connect) callbacks->on_connect(client_id);
+            });
+        }
+        
+        FrameChunk chunk;
+        while (!conn->holding && conn->decoder.next(chunk)) {
+            const FrameHeader& header = *chunk.header;
+            if (header.opcode >= 0x08) {
+                if (!handleControl(conn, chunk)) return false;
+                continue;
+            }
+            if (chunk.begin && !beginFrame(conn, header)) return false;
+            if (!appendPayload(conn, chunk)) return false;
+            if (chunk.end && header.fin && !completeMessage(conn, chunk)) return false;
+        }
+        
+        return true;
+    }
+    
+    bool handleControl(const std::shared_ptr<Connection>& conn, const FrameChunk& chunk) {
+        const FrameHeader& header = *chunk.header;
+        if (chunk.begin && (!header.fin || header.rsv1 || header.length > 125)) {
+            return fail(conn, 1002, "Malformed control frame");
+        }
+        if (!chunk.whole()) {
+            if (chunk.begin) conn->control.clear();
+            conn->control.append(chunk.data.data(), chunk.data.size());
+            if (!chunk.end) return true;
+        }
+        std::string_view payload = chunk.whole() ? chunk.data : std::string_view(conn->control);
+        
+        if (header.opcode == 0x08) {
+            queueFrame(conn, encodeFrame(payload.substr(0, 2), 0x08));
+            return false;
+        }
+        if (header.opcode == 0x09) {
+            queueFrame(conn, encodeFrame(payload, 0x0A));
+        }
+        return true;
+    }
+    
+    bool beginFrame(const std::shared_ptr<Connection>& conn, const FrameHeader& header) {
+        InboundMessage& message = conn->message;
+        if (header.opcode == 0x00) {
+            if (!message.active || header.rsv1) return fail(conn, 1002, "Unexpected continuation frame");
+        } else if (header.opcode == 0x01 || header.opcode == 0x02) {
+            if (message.active) return fail(conn, 1002, "Data frame interleaved with fragmented message");
+            if (header.rsv1 && !conn->inflater) return fail(conn, 1002, "Compressed frame without negotiated permessage-deflate");
+            message = InboundMessage();
+            message.active = true;
+            message.opcode = header.opcode;
+            message.compressed = header.rsv1;
+        } else {
+            return fail(conn, 1002, "Unknown opcode " + std::to_string(header.opcode));
+        }
+        
+        if (!message.compressed && message.size + header.length > max_message_size_) {
+            return fail(conn, 1009, "Message exceeds " + std::to_string(max_message_size_) + " bytes");
+        }
+        return true;
+    }
+    
+    bool appendPayload(const std::shared_ptr<Connection>& conn, const FrameChunk& chunk) {
+        if (chunk.data.empty()) return true;
+        if (conn->message.compressed) {
+            if (conn->inflater->inflate(chunk.data, [&](std::string_view data) { return deliver(conn, data); })) return true;
+            return failMessage(conn);
+        }
+        if (chunk.whole() && chunk.header->fin && chunk.header->opcode != 0x00) return true;
+        return deliver(conn, chunk.data) || failMessage(conn);
+    }
+    
+    bool deliver(const std::shared_ptr<Connection>& conn, std::string_view data) {
+        InboundMessage& message = conn->message;
+        message.size += data.size();
+        if (message.size > max_message_size_) {
+            message.oversized = true;
+            return false;
+        }
+        message.payload.append(data.data(), data.size());
+        return true;
+    }
+    
+    bool failMessage(const std::shared_ptr<Connection>& conn) {
+        if (conn->message.oversized) {
+            return fail(conn, 1009, "Message exceeds " + std::to_string(max_message_size_) + " bytes");
+        }
+        return fail(conn, 1007, "Failed to inflate compressed message");
+    }
+    
+    bool fail(const std::shared_ptr<Connection>& conn, uint16_t code, const std::string& reason) {
+        LOG_WARN("[WebSocketServer] Client " + std::to_string(conn->id) + ": " + reason + ", closing with " + std::to_string(code));
+        std::string payload;
+        payload.push_back(static_cast<char>(code >> 8));
+        payload.push_back(static_cast<char>(code & 0xFF));
+        payload += reason.substr(0, 123);
+        queueFrame(conn, encodeFrame(payload, 0x08));
+        conn->message = InboundMessage();
+        return false;
+    }
+    
+    bool completeMessage(const std::shared_ptr<Connection>& conn, const FrameChunk& chunk) {
+        if (conn->message.compressed && !conn->inflater->finish([&](std::string_view data) { return deliver(conn, data); })) {
+            return failMessage(conn);
+        }
+        
+        InboundMessage message = std::move(conn->message);
+        conn->message = InboundMessage();
+        bool zero_copy = !message.compressed && chunk.whole() && chunk.header->opcode != 0x00;
+        std::string payload = zero_copy ? std::string(chunk.data) : std::move(message.payload);
+        
+        int client_id = conn->id;
+        if (!inline_dispatch_) {
+            conn->strand->post([callbacks = callbacks_, client_id, payload = std::move(payload)] {
+                if (callbacks->on_message) callbacks->on_message(client_id, payload);
+            });
+            return true;
+        }
+        if (!callbacks_->on_message || callbacks_->on_message(client_id, payload)) return true;
+        
+        conn->held = std::move(payload);
+        conn->holding = true;
+        paused_reads_.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(conn->send_mutex);
+            conn->paused = true;
+            conn->loop->modify(conn->socket, interestOf(*conn));
+        }
+        scheduleResume(conn);
+        return true;
+    }
+    
+    void scheduleResume(const std::shared_ptr<Connection>& conn) {
+        std::weak_ptr<Connection> weak = conn;
+        TimerQueue::instance().schedule(kResumeInterval, [this, weak] {
+            if (auto conn = weak.lock()) {
+                conn->loop->post([this, conn] { resume(conn); });
+            }
+        });
+    }
+    
+    void resume(const std::shared_ptr<Connection>& conn) {
+        {
+            std::lock_guard<std::mutex> lock(conn->send_mutex);
+            if (conn->closed) return;
+        }
+        if (!conn->holding) return;
+        if (!callbacks_->on_message(conn->id, conn->held)) {
+            scheduleResume(conn);
+            return;
+        }
+        
+        conn->holding = false;
+        std::string().swap(conn->held);
+        if (!processInbound(conn)) {
+            closeConnection(conn, true);
+            return;
+        }
+        if (conn->holding) return;
+        
+        std::lock_guard<std::mutex> lock(conn->send_mutex);
+        conn->paused = false;
+        conn->loop->modify(conn->socket, interestOf(*conn));
+    }
+    
+    static uint32_t interestOf(const Connection& conn) {
+        return (conn.paused ? 0 : EventLoop::Readable) | (conn.outbound.empty() ? 0 : EventLoop::Writable);
+    }
+    
+    void dispatch(const std::shared_ptr<Connection>& conn, Strand::Task task) {
+        if (inline_dispatch_) {
+            task();
+        } else {
+            conn->strand->post(std::move(task));
+        }
+    }
+    
+    bool queueMessage(const std::shared_ptr<Connection>& conn, std::string_view message) {
+        std::lock_guard<std::mutex> lock(conn->deflate_mutex);
+        if (message.size() < deflate_options_.min_size) {
+            DeflateStats::instance().recordSkipped();
+            return queueFrame(conn, encodeFrame(message, 0x01));
+        }
+        
+        std::string compressed;
+        if (!conn->deflater->compress(message, compressed)) return false;
+        return queueFrame(conn, encodeFrame(compressed, 0x01, true));
+    }
+    
+    bool queueFrame(const std::shared_ptr<Connection>& conn, const std::vector<uint8_t>& frame) {
+        return queueBytes(conn, (const char*)frame.data(), frame.size());
+    }
+    
+    bool queueBytes(const std::shared_ptr<Connection>& conn, const char* data, size_t len) {
+        std::lock_guard<std::mutex> lock(conn->send_mutex);
+        if (conn->closed) return false;
+        
+        if (conn->outbound.empty()) {
+            int sent = ::send(conn->socket, data, (int)len, EventLoop::kSendFlags);
+            if (sent < 0) {
+                if (!EventLoop::wouldBlock()) {
+                    conn->loop->post([this, conn] { closeConnection(conn, true); });
+                    return false;
                 }
+                sent = 0;
             }
+            data += sent;
+            len -= static_cast<size_t>(sent);
+            if (len == 0) return true;
+            conn->outbound.append(data, len);
+            conn->loop->modify(conn->socket, interestOf(*conn));
+            return true;
         }
         
-    disconnect:
-        if (on_disconnect_) on_disconnect_(client_id);
-        removeClient(client_id);
+        conn->outbound.append(data, len);
+        return true;
     }
     
-    bool performHandshake(int client_id, SOCKET socket) {
-        char buffer[8192];
-        int received = recv(socket, buffer, sizeof(buffer) - 1, 0);
-        if (received <= 0) return false;
+    bool flush(const std::shared_ptr<Connection>& conn) {
+        std::lock_guard<std::mutex> lock(conn->send_mutex);
+        if (conn->closed) return false;
+        
+        while (!conn->outbound.empty()) {
+            int sent = ::send(conn->socket, conn->outbound.data(), (int)conn->outbound.size(), EventLoop::kSendFlags);
+            if (sent < 0) {
+                return EventLoop::wouldBlock();
+            }
+            conn->outbound.erase(0, static_cast<size_t>(sent));
+        }
         
-        buffer[received] = '\0';
-        std::string request(buffer);
+        conn->loop->modify(conn->socket, interestOf(*conn));
+        return true;
+    }
+    
+    void closeConnection(const std::shared_ptr<Connection>& conn, bool notify) {
+        {
+            std::lock_guard<std::mutex> lock(conn->send_mutex);
+            if (conn->closed) return;
+            conn->closed = true;
+            conn->outbound.clear();
+        }
         
+        conn->loop->remove(conn->socket);
+        closesocket(conn->socket);
+        
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex_);
+            auto it = clients_.find(conn->id);
+            if (it != clients_.end() && it->second == conn) clients_.erase(it);
+        }
+        
+        if (notify && conn->handshake_complete) {
+            int client_id = conn->id;
+            dispatch(conn, [callbacks = callbacks_, client_id] {
+                if (callbacks->on_disconnect) callbacks->on_disconnect(client_id);
+            });
+        }
+    }
+    
+    int authorize(const std::string& request) const {
+        if (access_token_.empty()) return 0;
+        
+        std::string presented = PerMessageDeflate::headerValue(request, "Authorization");
+        size_t space = presented.find(' ');
+        if (space != std::string::npos) {
+            std::string scheme = presented.substr(0, space);
+            for (auto& c : scheme) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            if (scheme == "bearer" || scheme == "token") {
+                presented = presented.substr(space + 1);
+            }
+        }
+        if (presented.empty()) presented = queryParameter(request, "access_token");
+        if (presented.empty()) return 401;
+        
+        unsigned char diff = presented.size() == access_token_.size() ? 0 : 1;
+        for (size_t i = 0; i < presented.size(); ++i) {
+            diff |= static_cast<unsigned char>(presented[i] ^ access_token_[i % access_token_.size()]);
+        }
+        return diff == 0 ? 0 : 403;
+    }
+    
+    static std::string queryParameter(const std::string& request, const std::string& name) {
+        size_t line_end = request.find("\r\n");
+        std::string line = request.substr(0, line_end);
+        size_t target = line.find(' ');
+        size_t query = line.find('?', target);
+        if (target == std::string::npos || query == std::string::npos) return std::string();
+        size_t query_end = line.find(' ', query);
+        std::string params = line.substr(query + 1, query_end == std::string::npos ? std::string::npos : query_end - query - 1);
+        
+        std::istringstream iss(params);
+        std::string pair;
+        while (std::getline(iss, pair, '&')) {
+            size_t eq = pair.find('=');
+            if (eq == std::string::npos || pair.compare(0, eq, name) != 0 || eq != name.size()) continue;
+            std::string value;
+            for (size_t i = eq + 1; i < pair.size(); ++i) {
+                if (pair[i] == '%' && i + 2 < pair.size() && std::isxdigit(static_cast<unsigned char>(pair[i + 1])) &&
+                    std::isxdigit(static_cast<unsigned char>(pair[i + 2]))) {
+                    value += static_cast<char>(std::stoi(pair.substr(i + 1, 2), nullptr, 16));
+                    i += 2;
+                } else {
+                    value += pair[i] == '+' ? ' ' : pair[i];
+                }
+            }
+            return value;
+        }
+        return std::string();
+    }
+    
+    std::string handshakeResponse(const std::shared_ptr<Connection>& conn, const std::string& request) {
         if (request.find("GET") == std::string::npos) {
-            return false;
+            return std::string();
         }
         
         std::string key;
@@ -240,7 +664,7 @@ private:
             }
         }
         
-        if (key.empty()) return false;
+        if (key.empty()) return std::string();
         
         std::string accept_key = computeAcceptKey(key);
         
@@ -249,12 +673,20 @@ private:
         response << "Upgrade: websocket\r\n";
         response << "Connection: Upgrade\r\n";
         response << "Sec-WebSocket-Accept: " << accept_key << "\r\n";
-        response << "\r\n";
         
-        std::string resp = response.str();
-        ::send(socket, resp.c_str(), (int)resp.size(), 0);
+        std::string offers = PerMessageDeflate::headerValue(request, "Sec-WebSocket-Extensions");
+        if (deflate_options_.enabled && PerMessageDeflate::available() && !offers.empty()) {
+            DeflateParams params;
+            std::string extension;
+            if (PerMessageDeflate::negotiate(offers, deflate_options_, params, extension)) {
+                conn->deflater = std::make_unique<MessageDeflater>(params.deflate_window_bits, params.deflate_reset, deflate_options_.level);
+                conn->inflater = std::make_unique<MessageInflater>(params.inflate_reset);
+                response << "Sec-WebSocket-Extensions: " << extension << "\r\n";
+            }
+        }
+        response << "\r\n";
         
-        return true;
+        return response.str();
     }
     
     std::string computeAcceptKey(const std::string& key) {
@@ -329,88 +761,47 @@ private:
         return result;
     }
     
-    std::vector<uint8_t> encodeFrame(const std::string& payload, uint8_t opcode) {
-        std::vector<uint8_t> frame;
-        frame.push_back(0x80 | opcode);
+    std::vector<uint8_t> encodeFrame(std::string_view payload, uint8_t opcode, bool compressed = false) {
+        size_t length_bytes = payload.size() < 126 ? 0 : (payload.size() < 65536 ? 2 : 8);
+        std::vector<uint8_t> frame(2 + length_bytes + payload.size());
+        uint8_t* out = frame.data();
+        *out++ = 0x80 | (compressed ? 0x40 : 0x00) | opcode;
         
         if (payload.size() < 126) {
-            frame.push_back(static_cast<uint8_t>(payload.size()));
+            *out++ = static_cast<uint8_t>(payload.size());
         } else if (payload.size() < 65536) {
-            frame.push_back(126);
-            frame.push_back((payload.size() >> 8) & 0xFF);
-            frame.push_back(payload.size() & 0xFF);
+            *out++ = 126;
+            *out++ = (payload.size() >> 8) & 0xFF;
+            *out++ = payload.size() & 0xFF;
         } else {
-            frame.push_back(127);
+            *out++ = 127;
             for (int i = 7; i >= 0; --i) {
-                frame.push_back((payload.size() >> (i * 8)) & 0xFF);
-            }
-        }
-        
-        frame.insert(frame.end(), payload.begin(), payload.end());
-        return frame;
-    }
-    
-    std::tuple<uint8_t, std::string, size_t> decodeFrame(const uint8_t* data, size_t len) {
-        if (len < 2) return {0, "", 0};
-        
-        uint8_t opcode = data[0] & 0x0F;
-        bool masked = (data[1] & 0x80) != 0;
-        uint64_t payload_len = data[1] & 0x7F;
-        size_t offset = 2;
-        
-        if (payload_len == 126) {
-            if (len < 4) return {0, "", 0};
-            payload_len = (data[2] << 8) | data[3];
-            offset = 4;
-        } else if (payload_len == 127) {
-            if (len < 10) return {0, "", 0};
-            payload_len = 0;
-            for (int i = 0; i < 8; ++i) {
-                payload_len = (payload_len << 8) | data[2 + i];
+                *out++ = (payload.size() >> (i * 8)) & 0xFF;
             }
-            offset = 10;
         }
         
-        uint8_t mask[4] = {0};
-        if (masked) {
-            if (len < offset + 4) return {0, "", 0};
-            std::memcpy(mask, data + offset, 4);
-            offset += 4;
-        }
-        
-        if (len < offset + payload_len) return {0, "", 0};
-        
-        std::string payload(payload_len, '\0');
-        for (size_t i = 0; i < payload_len; ++i) {
-            payload[i] = data[offset + i] ^ mask[i % 4];
-        }
-        
-        return {opcode, payload, offset + payload_len};
-    }
-    
-    void removeClient(int client_id) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_id);
-        if (it != clients_.end()) {
-            closesocket(it->second.socket);
-            if (it->second.recv_thread.joinable() && 
-                it->second.recv_thread.get_id() != std::this_thread::get_id()) {
-                it->second.recv_thread.detach();
-            }
-            clients_.erase(it);
+        if (!payload.empty()) {
+            std::memcpy(out, payload.data(), payload.size());
         }
+        return frame;
     }
     
     std::atomic<bool> running_;
     SOCKET server_socket_;
-    std::thread accept_thread_;
-    std::map<int, Client> clients_;
-    std::mutex clients_mutex_;
+    std::map<int, std::shared_ptr<Connection>> clients_;
+    mutable std::mutex clients_mutex_;
     std::atomic<int> next_client_id_;
     
-    MessageCallback on_message_;
-    ConnectCallback on_connect_;
-    DisconnectCallback on_disconnect_;
+    EventLoopGroup& loops_;
+    WorkerPool& workers_;
+    EventLoop* listen_loop_ = nullptr;
+    std::shared_ptr<Callbacks> callbacks_;
+    DeflateOptions deflate_options_;
+    std::string access_token_;
+    bool inline_dispatch_ = false;
+    uint64_t max_message_size_ = kDefaultMaxMessageSize;
+    std::atomic<uint64_t> rejected_handshakes_{0};
+    std::atomic<uint64_t> paused_reads_{0};
 };
 
 }
@@ -91,7 +91,7 @@ public:
             return false;
         }
         
-        std::string sender_name = event.sender.card.empty() ? event.sender.nickname : event.sender.card;
+        const std::string& sender_name = event.senderName();
         std::string context_key = "g_" + std::to_string(event.group_id);
         
         ContextDatabase::instance().addMessage(context_key, "user", content, sender_name, event.user_id);
@@ -248,7 +248,7 @@ private:
     bool handleChat(const MessageEvent& event, const std::string& content) {
         LOG_INFO("[AI] Chat: " + content.substr(0, 50) + "...");
         
-        std::string sender_name = event.sender.card.empty() ? event.sender.nickname : event.sender.card;
+        const std::string& sender_name = event.senderName();
         
         std::string response;
         if (event.isGroup()) {
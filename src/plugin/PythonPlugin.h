@@ -27,7 +27,7 @@ namespace LCHBOT {
 
 struct PythonTask {
     std::string plugin_name;
-    std::string event_json;
+    MessageEventPtr event;
     std::function<void(const std::string&, int64_t)> send_group_callback;
     std::function<void(const std::string&, int64_t)> send_private_callback;
 };
@@ -505,6 +505,8 @@ public:
         }
         master_list += "]";
         
+        std::string wire_format = ConfigManager::instance().config().internal_format == "msgpack" ? "msgpack" : "json";
+        
         std::string init_code = 
             "if '_lchbot_plugins' not in globals():\n"
             "    _lchbot_plugins = {}\n"
@@ -512,6 +514,7 @@ public:
             "_lchbot_api_request = None\n"
             "_lchbot_api_response = None\n"
             "_lchbot_master_qq = " + master_list + "\n"
+            "_lchbot_wire_format = '" + wire_format + "'\n"
             "\n"
             "class LCHBotPlugin:\n"
             "    def __init__(self):\n"
@@ -548,6 +551,16 @@ public:
             "        queue_file = 'data/py_msg_queue.jsonl'\n"
             "        os.makedirs('data', exist_ok=True)\n"
             "        msg = {'action': action, 'target_id': int(target_id), 'message': str(message), 'ts': int(time.time()*1000)}\n"
+            "        if _lchbot_wire_format == 'msgpack':\n"
+            "            try:\n"
+            "                import msgpack\n"
+            "                with threading.Lock():\n"
+            "                    with open('data/py_msg_queue.msgpack', 'ab') as f:\n"
+            "                        f.write(msgpack.packb(msg, use_bin_type=True))\n"
+            "                print(f'[LCHBOT] msg persisted: {action}={target_id}, len={len(message)}')\n"
+            "                return\n"
+            "            except ImportError:\n"
+            "                pass\n"
             "        with threading.Lock():\n"
             "            with open(queue_file, 'a', encoding='utf-8') as f:\n"
             "                f.write(json.dumps(msg, ensure_ascii=False) + '\\n')\n"
@@ -651,17 +664,18 @@ public:
         if (!loaded_) return false;
         
         try {
-            std::string event_json = createEventJson(event);
-            
             if (context_ && context_->getApi()) {
                 auto* api = context_->getApi();
+                int64_t route = OneBotApi::currentRoute();
                 PythonTask task;
                 task.plugin_name = info_.name;
-                task.event_json = event_json;
-                task.send_group_callback = [api](const std::string& msg, int64_t gid) {
+                task.event = event.share();
+                task.send_group_callback = [api, route](const std::string& msg, int64_t gid) {
+                    OneBotApi::RouteScope scope(route);
                     api->sendGroupMsg(gid, msg);
                 };
-                task.send_private_callback = [api](const std::string& msg, int64_t uid) {
+                task.send_private_callback = [api, route](const std::string& msg, int64_t uid) {
+                    OneBotApi::RouteScope scope(route);
                     api->sendPrivateMsg(uid, msg);
                 };
                 PythonTaskQueue::instance().submitTask(std::move(task));
@@ -676,14 +690,11 @@ public:
         if (!loaded_) return false;
         
         try {
-            std::string event_json = createEventJson(event);
-            std::string escaped_json = escapeForPython(event_json);
-            
             auto& py = PythonInterpreter::instance();
             std::string code = 
                 "import json\n"
                 "try:\n"
-                "    _lchbot_event = json.loads(" + escaped_json + ")\n"
+                "    _lchbot_event = json.loads(" + event.toPythonLiteral() + ")\n"
                 "    if '" + info_.name + "' in _lchbot_plugins:\n"
                 "        _lchbot_plugins['" + info_.name + "'].on_private_message(_lchbot_event)\n"
                 "except Exception as e:\n"
@@ -700,14 +711,11 @@ public:
         if (!loaded_) return false;
         
         try {
-            std::string event_json = createEventJson(event);
-            std::string escaped_json = escapeForPython(event_json);
-            
             auto& py = PythonInterpreter::instance();
             std::string code = 
                 "import json\n"
                 "try:\n"
-                "    _lchbot_event = json.loads(" + escaped_json + ")\n"
+                "    _lchbot_event = json.loads(" + event.toPythonLiteral() + ")\n"
                 "    if '" + info_.name + "' in _lchbot_plugins:\n"
                 "        _lchbot_plugins['" + info_.name + "'].on_group_message(_lchbot_event)\n"
                 "except Exception as e:\n"
@@ -721,66 +729,6 @@ public:
     }
     
 private:
-    std::string escapeForPython(const std::string& json) {
-        std::string result = "\"";
-        for (size_t i = 0; i < json.size(); ++i) {
-            unsigned char c = static_cast<unsigned char>(json[i]);
-            if (c == '\\') {
-                result += "\\\\";
-            } else if (c == '"') {
-                result += "\\\"";
-            } else if (c == '\n') {
-                result += "\\n";
-            } else if (c == '\r') {
-                result += "\\r";
-            } else if (c == '\t') {
-                result += "\\t";
-            } else if (c < 0x20) {
-                char buf[8];
-                snprintf(buf, sizeof(buf), "\\x%02x", c);
-                result += buf;
-            } else {
-                result += static_cast<char>(c);
-            }
-        }
-        result += "\"";
-        return result;
-    }
-    
-    std::string createEventJson(const MessageEvent& event) {
-        std::map<std::string, JsonValue> obj;
-        obj["message_type"] = JsonValue(event.isGroup() ? "group" : "private");
-        obj["sub_type"] = JsonValue(event.sub_type);
-        obj["message_id"] = JsonValue(static_cast<int64_t>(event.message_id));
-        obj["user_id"] = JsonValue(event.user_id);
-        obj["group_id"] = JsonValue(event.group_id);
-        obj["raw_message"] = JsonValue(event.raw_message);
-        obj["time"] = JsonValue(event.time);
-        obj["self_id"] = JsonValue(event.self_id);
-        
-        std::map<std::string, JsonValue> sender;
-        sender["user_id"] = JsonValue(event.sender.user_id);
-        sender["nickname"] = JsonValue(event.sender.nickname);
-        sender["card"] = JsonValue(event.sender.card);
-        sender["role"] = JsonValue(event.sender.role);
-        obj["sender"] = JsonValue(sender);
-        
-        std::vector<JsonValue> message;
-        for (const auto& seg : event.message) {
-            std::map<std::string, JsonValue> seg_obj;
-            seg_obj["type"] = JsonValue(seg.type);
-            std::map<std::string, JsonValue> data;
-            for (const auto& [k, v] : seg.data) {
-                data[k] = JsonValue(v);
-            }
-            seg_obj["data"] = JsonValue(data);
-            message.push_back(JsonValue(seg_obj));
-        }
-        obj["message"] = JsonValue(message);
-        
-        return JsonParser::stringify(JsonValue(obj));
-    }
-    
     struct ReplyInfo {
         bool is_group;
         int64_t target_id;
@@ -844,30 +792,14 @@ inline void PythonPipelineScheduler::workerLoop(int worker_id) {
         
         try {
             auto& py = PythonInterpreter::instance();
-            std::string escaped_json = "\"";
-            for (char c : task.event_json) {
-                if (c == '\\') escaped_json += "\\\\";
-                else if (c == '"') escaped_json += "\\\"";
-                else if (c == '\n') escaped_json += "\\n";
-                else if (c == '\r') escaped_json += "\\r";
-                else if (c == '\t') escaped_json += "\\t";
-                else escaped_json += c;
-            }
-            escaped_json += "\"";
-            
-            std::string cache_json = GroupMemberCache::instance().toJson();
-            std::string escaped_cache;
-            for (char c : cache_json) {
-                if (c == '\\') escaped_cache += "\\\\";
-                else if (c == '\'') escaped_cache += "\\'";
-                else escaped_cache += c;
-            }
+            const std::string& escaped_json = task.event->toPythonLiteral();
+            std::string escaped_cache = GroupMemberCache::instance().toPythonLiteral();
             
             std::string code = 
                 "import json\n"
                 "import builtins\n"
                 "_lchbot_reply_queue = []\n"
-                "builtins._lchbot_member_cache = '" + escaped_cache + "'\n"
+                "builtins._lchbot_member_cache = " + escaped_cache + "\n"
                 "try:\n"
                 "    _lchbot_event = json.loads(" + escaped_json + ")\n"
                 "    if '" + task.plugin_name + "' in _lchbot_plugins:\n"
@@ -919,14 +851,7 @@ inline void PythonPipelineScheduler::workerLoop(int worker_id) {
             };
             
             auto syncMemberCache = [&]() {
-                std::string cache_json = GroupMemberCache::instance().toJson();
-                std::string escaped;
-                for (char c : cache_json) {
-                    if (c == '\\') escaped += "\\\\";
-                    else if (c == '\'') escaped += "\\'";
-                    else escaped += c;
-                }
-                py.executeString("_lchbot_member_cache = '" + escaped + "'\n");
+                py.executeString("_lchbot_member_cache = " + GroupMemberCache::instance().toPythonLiteral() + "\n");
             };
             syncMemberCache();
             